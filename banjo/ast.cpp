@@ -23,6 +23,74 @@ Namespace_decl::Namespace_decl(Decl& cxt, Name& n)
 { }
 
 
+// Create a class with its own member scope. The number `k`, which
+// is assigned by the context, supports base class queries.
+Class_decl::Class_decl(Name& n, std::size_t k)
+  : Type_decl(n)
+  , lookup(new Class_scope(*this))
+  , uid(k)
+  , cached(false)
+{ }
+
+
+Class_decl::~Class_decl()
+{ }
+
+
+// Set the offset of each template parameter in `ps`. The depth
+// of each parameter is assigned when it is declared.
+inline void
+index_template_parameters(Decl_list& ps)
+{
+  int n = 0;
+  for (Decl& p : ps)
+    parameter_index(p).second = n++;
+}
+
+
+Template_decl::Template_decl(Decl_list const& p, Decl& d)
+  : Decl(d.name()), parms(p), cons(nullptr), decl(&d), hits(0), misses(0)
+{
+  lingo_assert(!d.context());
+  d.context(*this);
+  index_template_parameters(parms);
+}
+
+
+Concept_decl::Concept_decl(Name& n, Decl_list const& ps)
+  : Decl(n), parms(ps), def(nullptr), cons(nullptr), props()
+{
+  index_template_parameters(parms);
+}
+
+
+Concept_decl::Concept_decl(Name& n, Decl_list const& ps, Def& d)
+  : Decl(n), parms(ps), def(&d), cons(nullptr), props()
+{
+  index_template_parameters(parms);
+}
+
+
+Index
+parameter_index(Decl const& d)
+{
+  return parameter_index(const_cast<Decl&>(d));
+}
+
+
+Index&
+parameter_index(Decl& d)
+{
+  if (Type_parm* p = as<Type_parm>(&d))
+    return p->index();
+  if (Value_parm* p = as<Value_parm>(&d))
+    return p->index();
+  if (Template_parm* p = as<Template_parm>(&d))
+    return p->index();
+  lingo_unreachable();
+}
+
+
 // Returns true if `t` is an object type. That is, any type
 // except function types and reference types.
 //
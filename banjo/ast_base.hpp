@@ -167,6 +167,17 @@ struct Term
 };
 
 
+// Records whether a type or expression mentions template parameters.
+// This is computed on demand and cached in the term. See is_dependent()
+// in substitution.hpp.
+enum Dependence : char
+{
+  unknown_dep,     // Not yet computed
+  dependent_dep,   // Mentions template parameters
+  nondependent_dep // Does not mention template parameters
+};
+
+
 // -------------------------------------------------------------------------- //
 // Lists
 
@@ -6,6 +6,11 @@
 
 #include "ast_base.hpp"
 #include "specifier.hpp"
+#include "hash.hpp"
+
+#include <boost/dynamic_bitset.hpp>
+
+#include <memory>
 
 
 namespace banjo
@@ -253,9 +258,17 @@ struct Function_decl : Decl
 
 
 // Represents the declaration of a class.
+//
+// Each class owns a scope that contains its member declarations,
+// and a cache of information about its base classes. The cache
+// is computed by base_classes() (see inheritance.cpp), and it is
+// retained only when the class and its bases are complete.
+//
+// Classes are numbered by the context in which they are created.
 struct Class_decl : Type_decl
 {
-  using Type_decl::Type_decl;
+  Class_decl(Name&, std::size_t);
+  ~Class_decl();
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
@@ -267,6 +280,20 @@ struct Class_decl : Type_decl
 
   // Returns true if the declaration is also a definition.
   bool is_definition() const { return def; }
+
+  // Returns the scope containing the class's members.
+  Scope const* scope() const { return lookup.get(); }
+  Scope*       scope()       { return lookup.get(); }
+
+  // Returns a number that uniquely identifies the class within
+  // its context.
+  std::size_t number() const { return uid; }
+
+  std::unique_ptr<Scope>   lookup;
+  std::size_t              uid;
+  bool                     cached;  // True if the cache below is valid
+  std::vector<Class_decl*> bases;   // Linearized list of base classes
+  boost::dynamic_bitset<>  closure; // Set of base class numbers
 };
 
 
@@ -347,17 +374,21 @@ struct Namespace_decl : Decl
 // a logical proposition for the purpose of constraint checking
 // and comparison.
 //
+// The template also records each of its specializations, indexed
+// by their canonical template arguments. The number of lookups that
+// found (hits) or created (misses) a specialization are counted.
+//
 // TODO: Consider making a template parameter list a special
 // term. We can linke template parameter lists and their
 // constraints. Of course, this may not be necessary.
 struct Template_decl : Decl
 {
-  Template_decl(Decl_list const& p, Decl& d)
-    : Decl(d.name()), parms(p), cons(nullptr), decl(&d)
-  {
-    lingo_assert(!d.context());
-    d.context(*this);
-  }
+  using Specialization_map = std::unordered_map<
+    Term_list, Decl*, Term_list_hash, Term_list_eq
+  >;
+  using Argument_map = std::unordered_map<Decl const*, Term_list>;
+
+  Template_decl(Decl_list const& p, Decl& d);
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
@@ -383,22 +414,46 @@ struct Template_decl : Decl
   Decl const& parameterized_declaration() const { return *decl; }
   Decl&       parameterized_declaration()       { return *decl; }
 
-  Decl_list parms;
-  Expr*     cons;
-  Decl*     decl;
+  // Returns the specializations of the template.
+  Specialization_map const& specializations() const { return specs; }
+  Specialization_map&       specializations()       { return specs; }
+
+  // Returns the converted template arguments of the specialization
+  // `d`. Behavior is undefined if `d` is not a specialization of
+  // this template.
+  Term_list const& specialization_arguments(Decl const& d) const { return args.at(&d); }
+  Term_list&       specialization_arguments(Decl const& d)       { return args.at(&d); }
+
+  Decl_list          parms;
+  Expr*              cons;
+  Decl*              decl;
+  Specialization_map specs;
+  Argument_map       args;
+  std::size_t        hits;
+  std::size_t        misses;
+};
+
+
+// Properties of a normalized constraint, used to estimate the cost
+// of expanding it. For concepts, these describe the normalized
+// definition, and are computed once.
+struct Constraint_props
+{
+  // Returns true if the constraint contains disjunctions.
+  bool is_disjunctive() const { return depth != 0; }
+
+  int  atoms;  // The number of atomic constraints
+  int  depth;  // The maximum nesting of disjunctions
+  int  checks; // The number of concept checks
+  bool known;  // True when the properties have been computed
 };
 
 
 // Represents a concept definition.
 struct Concept_decl : Decl
 {
-  Concept_decl(Name& n, Decl_list const& ps)
-    : Decl(n), parms(ps), def(nullptr)
-  { }
-
-  Concept_decl(Name& n, Decl_list const& ps, Def& d)
-    : Decl(n), parms(ps), def(&d)
-  { }
+  Concept_decl(Name& n, Decl_list const& ps);
+  Concept_decl(Name& n, Decl_list const& ps, Def& d);
 
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
@@ -414,6 +469,10 @@ struct Concept_decl : Decl
 
   Decl_list parms;
   Def*      def;
+  Cons*     cons; // The normalized definition, computed once
+
+  // Properties of the normalized definition, computed once.
+  Constraint_props props;
 };
 
 
@@ -605,6 +664,11 @@ struct Template_parm : Decl
 };
 
 
+// Returns the index of the template parameter `d`.
+Index  parameter_index(Decl const& d);
+Index& parameter_index(Decl& d);
+
+
 // A generic visitor for declarations.
 template<typename F, typename T>
 struct Generic_decl_visitor : Decl::Visitor, Generic_visitor<F, T>
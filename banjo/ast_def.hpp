@@ -122,22 +122,30 @@ struct Function_def : Def
 };
 
 
-// A definition of a class.
-//
-// FIXME: Add base classes.
+// A definition of a class. This includes the list of base classes
+// and the member declarations of the class.
 struct Class_def : Def
 {
   Class_def(Decl_list const& ds)
-    : decls(ds)
+    : base(), decls(ds)
+  { }
+
+  Class_def(Type_list const& bs, Decl_list const& ds)
+    : base(bs), decls(ds)
   { }
 
   void accept(Visitor& v) const { return v.visit(*this); }
   void accept(Mutator& v)       { return v.visit(*this); }
 
+  // Returns the list of direct base classes.
+  Type_list const& bases() const { return base; }
+  Type_list&       bases()       { return base; }
+
   // Returns the list of member declarations.
   Decl_list const& members() const { return decls; }
   Decl_list&       members()       { return decls; }
 
+  Type_list base;
   Decl_list decls;
 };
 
@@ -206,10 +214,10 @@ apply(Def const& t, F fn)
 
 // A generic mutator for definitions.
 template<typename F, typename T>
-struct Generic_def_mutator : Def::Mutator, Generic_visitor<F, T>
+struct Generic_def_mutator : Def::Mutator, Generic_mutator<F, T>
 {
   Generic_def_mutator(F f)
-    : Generic_visitor<F, T>(f)
+    : Generic_mutator<F, T>(f)
   { }
 
   void visit(Defaulted_def& d)  { this->invoke(d); }
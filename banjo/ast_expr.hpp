@@ -17,11 +17,11 @@ struct Expr : Term
   struct Mutator;
 
   Expr()
-    : ty(nullptr)
+    : ty(nullptr), dep(unknown_dep)
   { }
 
   Expr(Type& t)
-    : ty(&t)
+    : ty(&t), dep(unknown_dep)
   { }
 
   virtual void accept(Visitor&) const = 0;
@@ -30,7 +30,8 @@ struct Expr : Term
   Type const& type() const { return *ty; }
   Type&       type()       { return *ty; }
 
-  Type* ty;
+  Type*              ty;
+  mutable Dependence dep; // Cached dependence
 };
 
 
@@ -14,8 +14,10 @@ namespace banjo
 struct Stmt : Term
 {
   struct Visitor;
+  struct Mutator;
 
   virtual void accept(Visitor& v) const = 0;
+  virtual void accept(Mutator& v) = 0;
 };
 
 
@@ -28,6 +30,15 @@ struct Stmt::Visitor
 };
 
 
+struct Stmt::Mutator
+{
+  virtual void visit(Compound_stmt&) { }
+  virtual void visit(Expression_stmt&) { }
+  virtual void visit(Declaration_stmt&) { }
+  virtual void visit(Return_stmt&) { }
+};
+
+
 // A blocked sequence of statements.
 struct Compound_stmt : Stmt
 {
@@ -40,6 +51,7 @@ struct Compound_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  void accept(Mutator& v)       { v.visit(*this); }
 
   Stmt_list const& statements() const { return stmts; }
   Stmt_list&       statements()       { return stmts; }
@@ -57,6 +69,7 @@ struct Expression_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  void accept(Mutator& v)       { v.visit(*this); }
 
   // Returns the expression of the statement.
   Expr const& expression() const { return *expr; }
@@ -74,6 +87,7 @@ struct Declaration_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  void accept(Mutator& v)       { v.visit(*this); }
 
   // Returns the declaration of the statement.
   Decl const& declaration() const { return *decl; }
@@ -91,6 +105,7 @@ struct Return_stmt : Stmt
   { }
 
   void accept(Visitor& v) const { v.visit(*this); }
+  void accept(Mutator& v)       { v.visit(*this); }
 
   // Returns the expression returned by the statement.
   Expr const& expression() const { return *expr; }
@@ -125,6 +140,31 @@ apply(Stmt const& s, F fn)
 }
 
 
+// A generic mutator for statements.
+template<typename F, typename T>
+struct Generic_stmt_mutator : Stmt::Mutator, Generic_mutator<F, T>
+{
+  Generic_stmt_mutator(F f)
+    : Generic_mutator<F, T>(f)
+  { }
+
+  void visit(Compound_stmt& s)    { this->invoke(s); }
+  void visit(Expression_stmt& s)  { this->invoke(s); }
+  void visit(Declaration_stmt& s) { this->invoke(s); }
+  void visit(Return_stmt& s)      { this->invoke(s); }
+};
+
+
+// Apply a function to the given statement.
+template<typename F, typename T = typename std::result_of<F(Return_stmt&)>::type>
+inline T
+apply(Stmt& s, F fn)
+{
+  Generic_stmt_mutator<F, T> vis(fn);
+  return accept(s, vis);
+}
+
+
 } // namesapce banjo
 
 #endif
@@ -7,16 +7,33 @@
 #include "ast_base.hpp"
 #include "qualifier.hpp"
 
+#include <cstdint>
+
 
 namespace banjo
 {
 
+// A fingerprint of the type constructors along the spine of a type.
+// This is computed on demand and used to quickly reject template
+// argument deduction. See deduction.cpp.
+struct Type_shape
+{
+  std::uint64_t kinds; // Constructor kinds, 4 bits each, outermost first
+  int           len;   // Number of recorded kinds, or -1 if not computed
+  bool          open;  // True if the remainder of the type is unconstrained
+};
+
+
 // The base class of all types.
 struct Type : Term
 {
   struct Visitor;
   struct Mutator;
 
+  Type()
+    : dep(unknown_dep), shape{0, -1, false}
+  { }
+
   virtual void accept(Visitor&) const = 0;
   virtual void accept(Mutator&)       = 0;
 
@@ -33,6 +50,9 @@ struct Type : Term
   // Returns the non-reference version of this type.
   virtual Type const& non_reference_type() const { return *this; }
   virtual Type&       non_reference_type()       { return *this; }
+
+  mutable Dependence dep;   // Cached dependence
+  mutable Type_shape shape; // Cached shape
 };
 
 
@@ -291,6 +311,14 @@ struct Array_type : Type
   void accept(Visitor& v) const { v.visit(*this); }
   void accept(Mutator& v)       { v.visit(*this); }
 
+  // Returns the element type of the array.
+  Type const& type() const { return *first; }
+  Type&       type()       { return *first; }
+
+  // Returns the extent of the array.
+  Expr const& extent() const { return *second; }
+  Expr&       extent()       { return *second; }
+
   Type* first;
   Expr* second;
 };
@@ -0,0 +1,138 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "bdd.hpp"
+
+#include <climits>
+
+
+namespace banjo
+{
+
+constexpr Bdd::Node Bdd::false_node;
+constexpr Bdd::Node Bdd::true_node;
+
+
+Bdd::Bdd(std::size_t n)
+  : nodes {{INT_MAX, false_node, false_node}, {INT_MAX, true_node, true_node}},
+    limit(n)
+{ }
+
+
+// Discard all diagrams except the terminals. Previously returned
+// nodes are invalidated.
+void
+Bdd::clear()
+{
+  nodes.resize(2);
+  unique.clear();
+  memo.clear();
+}
+
+
+// Returns the diagram for the variable `v`.
+Bdd::Node
+Bdd::var(int v)
+{
+  return make(v, false_node, true_node);
+}
+
+
+// Returns the diagram for the negation of `a`.
+Bdd::Node
+Bdd::neg(Node a)
+{
+  return apply(not_op, a, false_node);
+}
+
+
+// Returns the diagram for the conjunction of `a` and `b`.
+Bdd::Node
+Bdd::conj(Node a, Node b)
+{
+  return apply(and_op, a, b);
+}
+
+
+// Returns the diagram for the disjunction of `a` and `b`.
+Bdd::Node
+Bdd::disj(Node a, Node b)
+{
+  return apply(or_op, a, b);
+}
+
+
+// Returns the unique node testing `v` with the given successors.
+// A test whose successors are the same is redundant.
+Bdd::Node
+Bdd::make(int v, Node lo, Node hi)
+{
+  if (lo == hi)
+    return lo;
+  auto ins = unique.emplace(Key(v, {lo, hi}), nodes.size());
+  if (ins.second)
+    nodes.push_back({v, lo, hi});
+  return ins.first->second;
+}
+
+
+// Apply the operation to the diagrams `a` and `b`. For negation,
+// `b` is ignored.
+Bdd::Node
+Bdd::apply(Op op, Node a, Node b)
+{
+  // Terminal cases.
+  switch (op) {
+  case and_op:
+    if (a == false_node || b == false_node)
+      return false_node;
+    if (a == true_node || a == b)
+      return b;
+    if (b == true_node)
+      return a;
+    break;
+  case or_op:
+    if (a == true_node || b == true_node)
+      return true_node;
+    if (a == false_node || a == b)
+      return b;
+    if (b == false_node)
+      return a;
+    break;
+  case not_op:
+    if (a == false_node)
+      return true_node;
+    if (a == true_node)
+      return false_node;
+    break;
+  }
+
+  // Both binary operations are commutative.
+  if (op != not_op && b < a)
+    std::swap(a, b);
+
+  Key key(op, {a, b});
+  auto iter = memo.find(key);
+  if (iter != memo.end())
+    return iter->second;
+
+  // Split on the least variable of the operands. Note that
+  // nodes may be added during recursion, so entries are copied.
+  Entry x = nodes[a];
+  Entry y = nodes[b];
+  int v = std::min(x.v, y.v);
+  Node a0 = x.v == v ? x.lo : a;
+  Node a1 = x.v == v ? x.hi : a;
+  Node b0 = y.v == v ? y.lo : b;
+  Node b1 = y.v == v ? y.hi : b;
+  Node lo = apply(op, a0, b0);
+  Node hi = apply(op, a1, b1);
+  Node r = make(v, lo, hi);
+  if (memo.size() >= limit)
+    memo.clear();
+  memo.emplace(key, r);
+  return r;
+}
+
+
+} // namespace banjo
@@ -0,0 +1,84 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#ifndef BANJO_BDD_HPP
+#define BANJO_BDD_HPP
+
+#include "prelude.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+
+namespace banjo
+{
+
+// A reduced, ordered binary decision diagram package. Diagrams are
+// identified by the index of their root node. Nodes are unique, so
+// equivalent formulas have the same diagram, and the results of
+// operations are memoized.
+//
+// Variables are ordered by their index; lower variables appear
+// closer to the root.
+//
+// The memo of operations is bounded: when it exceeds its limit, it
+// is discarded. Nodes are never freed individually; the package can
+// only be cleared as a whole.
+struct Bdd
+{
+  using Node = int;
+
+  // The terminal nodes.
+  static constexpr Node false_node = 0;
+  static constexpr Node true_node = 1;
+
+  explicit Bdd(std::size_t = 1 << 20);
+
+  void clear();
+
+  Node var(int);
+  Node neg(Node);
+  Node conj(Node, Node);
+  Node disj(Node, Node);
+
+  // Returns true if a implies b. That is, when a and not b is
+  // unsatisfiable.
+  bool implies(Node a, Node b) { return conj(a, neg(b)) == false_node; }
+
+  // Returns the number of nodes in the package.
+  std::size_t size() const { return nodes.size(); }
+
+  // Returns the number of memoized operations.
+  std::size_t cache_size() const { return memo.size(); }
+
+  // An interior node tests the variable `v`. Its low (high)
+  // successor is the diagram for a false (true) value of `v`.
+  // For terminal nodes, `v` is greater than any variable.
+  struct Entry
+  {
+    int  v;
+    Node lo;
+    Node hi;
+  };
+
+  enum Op : int { and_op, or_op, not_op };
+
+  using Key = std::pair<int, std::pair<Node, Node>>;
+  using Map = std::unordered_map<Key, Node, boost::hash<Key>>;
+
+  Node make(int, Node, Node);
+  Node apply(Op, Node, Node);
+
+  std::vector<Entry> nodes;  // All nodes, by index
+  Map                unique; // Unique table of interior nodes
+  Map                memo;   // Memoized operations
+  std::size_t        limit;  // The maximum size of the memo
+};
+
+
+} // namespace banjo
+
+
+#endif
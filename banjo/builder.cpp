@@ -128,17 +128,25 @@ Builder::get_destructor_id(Type const& t)
 }
 
 
+// Returns the template-id naming the specialization of `d` for
+// the arguments `t`. Template-ids are unique: equivalent argument
+// lists yield the same name. The arguments should be canonical
+// (see canonicalize_template_arguments).
 Template_id&
 Builder::get_template_id(Template_decl& d, Term_list const& t)
 {
-  return make<Template_id>(d, t);
+  static Factory<Template_id> f;
+  return f.make(d, t);
 }
 
 
+// Returns the unique concept-id naming the check of `d` for the
+// arguments `t`.
 Concept_id&
 Builder::get_concept_id(Concept_decl& d, Term_list const& t)
 {
-  return make<Concept_id>(d, t);
+  static Factory<Concept_id> f;
+  return f.make(d, t);
 }
 
 
@@ -428,6 +436,15 @@ Builder::make_reference(Object_parm& d)
 }
 
 
+// A value parameter is not an object, so a reference to it is
+// a value of its type.
+Reference_expr&
+Builder::make_reference(Value_parm& d)
+{
+  return make<Reference_expr>(d.type(), d);
+}
+
+
 // Make a concept check. The type is bool.
 Check_expr&
 Builder::make_check(Concept_decl& d, Term_list const& as)
@@ -636,6 +653,13 @@ Builder::make_class_definition(Decl_list const& ds)
 }
 
 
+Class_def&
+Builder::make_class_definition(Type_list const& bs, Decl_list const& ds)
+{
+  return make<Class_def>(bs, ds);
+}
+
+
 Concept_def&
 Builder::make_concept_definition(Req_list const& ss)
 {
@@ -695,14 +719,14 @@ Builder::make_function(char const* s, Decl_list const& ps, Type& r)
 Class_decl&
 Builder::make_class(Name& n)
 {
-  return make<Class_decl>(n);
+  return make<Class_decl>(n, cxt.classes++);
 }
 
 
 Class_decl&
 Builder::make_class(char const* s)
 {
-  return make<Class_decl>(get_id(s));
+  return make_class(get_id(s));
 }
 
 
@@ -86,6 +86,7 @@ struct Builder
   Reference_expr& make_reference(Constant_decl&);
   Reference_expr& make_reference(Function_decl&);
   Reference_expr& make_reference(Object_parm&);
+  Reference_expr& make_reference(Value_parm&);
   Check_expr&     make_check(Concept_decl&, Term_list const&);
 
   And_expr&       make_and(Type&, Expr&, Expr&);
@@ -121,6 +122,7 @@ struct Builder
   Expression_def& make_expression_definition(Expr&);
   Function_def&   make_function_definition(Stmt&);
   Class_def&      make_class_definition(Decl_list const&);
+  Class_def&      make_class_definition(Type_list const&, Decl_list const&);
   Concept_def&    make_concept_definition(Req_list const&);
 
   Namespace_decl& make_namespace(Name&);
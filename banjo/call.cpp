@@ -4,22 +4,31 @@
 #include "call.hpp"
 #include "initialization.hpp"
 #include "conversion.hpp"
+#include "overload.hpp"
+#include "expression.hpp"
+#include "lookup.hpp"
+#include "deduction.hpp"
+#include "template.hpp"
 #include "builder.hpp"
+#include "print.hpp"
+
+#include <algorithm>
 
 
 namespace banjo
 {
 
-// Initialize one parameter.
+// Initialize one parameter, advancing the parameter and argument
+// iterators.
 //
 // The parameter initial parameter and argument are provided
 // to compute parameter/argument offsets.
 Expr&
 initialize_parameter(Context& cxt,
                      Type_iter p0,
-                     Type_iter pi,
+                     Type_iter& pi,
                      Expr_iter a0,
-                     Expr_iter ai)
+                     Expr_iter& ai)
 {
   // TODO: Trap errors and use these to explain failures. If
   // we do get errors, what should we return?
@@ -41,6 +50,10 @@ initialize_parameters(Context& cxt, Type_list& parms, Expr_list& args)
   if (args.size() < parms.size())
     throw std::runtime_error("too few arguments");
 
+  // TODO: Handle variadic functions here.
+  if (args.size() > parms.size())
+    throw std::runtime_error("too many arguments");
+
   // Build a list of converted arguments by copy-initializing
   // each parameter in turn.
   Expr_list ret;
@@ -77,4 +90,291 @@ build_function_call(Context& cxt, Function_decl& f, Expr_list& args)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Overload resolution
+
+// A function ranked by the implicit conversions of its arguments.
+struct Ranked_candidate
+{
+  Function_decl*                   fn;
+  std::vector<Implicit_conversion> convs;
+};
+
+
+// Rank the function `f` for a call with the arguments `args`. Returns
+// false if the function is not viable. The implicit conversions are
+// memoized, so no conversions are built when checking a combination
+// of argument and parameter types that has been seen before.
+bool
+rank_candidate(Context& cxt,
+               Function_decl& f,
+               Expr_list& args,
+               Ranked_candidate& c)
+{
+  Type_list& parms = f.type().parameter_types();
+  if (parms.size() != args.size())
+    return false;
+
+  c.fn = &f;
+  c.convs.clear();
+  auto pi = parms.begin();
+  for (Expr& a : args) {
+    Implicit_conversion ic = get_implicit_conversion(cxt, a, *pi);
+    if (!ic.viable)
+      return false;
+    c.convs.push_back(ic);
+    ++pi;
+  }
+  return true;
+}
+
+
+// Adjust the type of the call argument `a` for deduction against
+// the parameter type `p`. Unless `p` is a reference type, references
+// and top-level qualifiers of the argument type are ignored.
+inline Type&
+get_deduction_argument_type(Type& p, Type& a)
+{
+  if (is<Reference_type>(&p))
+    return a;
+  Type* t = &a;
+  if (Reference_type* r = as<Reference_type>(t))
+    t = &r->type();
+  return t->unqualified_type();
+}
+
+
+// Deduce the template arguments of the function template `tmp` from
+// the arguments `args`. Returns the specialization for the deduced
+// arguments, or nullptr if deduction fails.
+//
+// TODO: Support default template arguments and explicitly specified
+// template arguments.
+inline Function_decl*
+deduce_candidate(Context& cxt, Template_decl& tmp, Expr_list& args)
+{
+  Function_decl& f = cast<Function_decl>(tmp.parameterized_declaration());
+  Type_list& parms = f.type().parameter_types();
+  if (parms.size() != args.size())
+    return nullptr;
+
+  Substitution sub(tmp.parameters());
+  auto pi = parms.begin();
+  for (Expr& a : args) {
+    if (!deduce_from_type(*pi, get_deduction_argument_type(*pi, a.type()), sub))
+      return nullptr;
+    ++pi;
+  }
+
+  // Every template parameter must be deduced.
+  Term_list targs;
+  for (Substitution::Mapping& m : sub) {
+    if (!m.first)
+      continue;
+    if (!m.second)
+      return nullptr;
+    targs.push_back(*m.second);
+  }
+  return &cast<Function_decl>(specialize_template(cxt, tmp, targs));
+}
+
+
+// Returns true if `f` is a specialization of a function template.
+inline bool
+is_specialization(Function_decl const& f)
+{
+  return is<Template_id>(&f.name());
+}
+
+
+// Returns true if `c1` is a better candidate than `c2`. This is the
+// case when no argument conversion for `c1` is worse than that for
+// `c2` and at least one is better. Otherwise, a function that is not
+// a template specialization is better than one that is.
+//
+// TODO: Prefer more specialized templates to less specialized ones.
+bool
+is_better_candidate(Ranked_candidate const& c1, Ranked_candidate const& c2)
+{
+  bool better = false;
+  for (std::size_t i = 0; i < c1.convs.size(); ++i) {
+    Conversion_comp cmp = compare(c1.convs[i], c2.convs[i]);
+    if (cmp == worse_conv)
+      return false;
+    if (cmp == better_conv)
+      better = true;
+  }
+  if (better)
+    return true;
+  return !is_specialization(*c1.fn) && is_specialization(*c2.fn);
+}
+
+
+// Resolve a call to one of the functions in the overload set `ovl`
+// with the given arguments, and build the call to the best viable
+// function.
+//
+// Only those candidates selected by the overload set's index are
+// checked for viability, so functions with the wrong number of
+// parameters or an incompatible first parameter are rejected without
+// building any conversions. Viable candidates are compared using
+// the memoized implicit conversions of their arguments, and the
+// argument conversions are built only for the selected function.
+//
+// For function templates, the candidate is the specialization for
+// the template arguments deduced from the call. The definition of
+// the selected specialization is requested.
+//
+// The selected function is saved in the overload set so that later
+// calls with the same argument types are resolved immediately.
+Expr&
+build_function_call(Context& cxt, Overload_set& ovl, Expr_list& args)
+{
+  // If we've resolved a call with the same argument types, then
+  // just call that function.
+  Type_seq key;
+  for (Expr& a : args)
+    key.push_back(&a.type());
+  ovl.update();
+  auto iter = ovl.resolved.find(key);
+  if (iter != ovl.resolved.end())
+    return build_function_call(cxt, cast<Function_decl>(*iter->second), args);
+
+  std::vector<Ranked_candidate> viable;
+  Ranked_candidate c;
+  for (Decl* d : ovl.candidates(args)) {
+    Function_decl* f = as<Function_decl>(d);
+    if (Template_decl* t = as<Template_decl>(d))
+      f = deduce_candidate(cxt, *t, args);
+    if (f && rank_candidate(cxt, *f, args, c))
+      viable.push_back(c);
+  }
+
+  if (viable.empty())
+    throw Type_error("no matching function for call to '{}'", ovl.name());
+
+  // Find a candidate that is not worse than any other, and then
+  // verify that it is better than all others.
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < viable.size(); ++i) {
+    if (is_better_candidate(viable[i], viable[best]))
+      best = i;
+  }
+  for (std::size_t i = 0; i < viable.size(); ++i) {
+    if (i != best && !is_better_candidate(viable[best], viable[i]))
+      throw Type_error("call to '{}' is ambiguous", ovl.name());
+  }
+
+  Function_decl& f = *viable[best].fn;
+  ovl.resolved.emplace(std::move(key), &f);
+  request_instantiation(cxt, f);
+  return build_function_call(cxt, f, args);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Named calls
+
+// Build a call to the expression `e`.
+//
+// TODO: This is going to be non-trivial.
+Expr&
+build_function_call(Context& cxt, Expr& e, Expr_list& args)
+{
+  Builder build(cxt);
+  if (Reference_expr* ref = as<Reference_expr>(&e)) {
+    Decl& d = ref->declaration();
+    Type& t = declared_type(d);
+    if (Function_type* f = as<Function_type>(&t))
+      return build.make_call(f->return_type(), e, args);
+
+    // FIXME: Handle lambda expressions. Handle objects of class
+    // type with overloads of '()'.
+
+    throw Translation_error("'{}' is not callable", e);
+  }
+
+  // FIXME: Handle overload sets.
+
+  lingo_unimplemented();
+}
+
+
+// Returns true if each declaration in `ovl` is a function or
+// function template.
+inline bool
+is_function_set(Overload_set const& ovl)
+{
+  for (Decl* d : ovl) {
+    if (!is<Function_decl>(&d->parameterized_declaration()))
+      return false;
+  }
+  return true;
+}
+
+
+// Build a call to the unqualified function name `id`. The candidates
+// are those found by unqualified lookup and those found by argument-
+// dependent lookup. The latter is not performed when unqualified
+// lookup finds something other than a function.
+//
+// When argument-dependent lookup finds no new declarations, the set
+// found by unqualified lookup is used directly, so that its saved
+// resolutions are reused.
+inline Expr&
+build_unqualified_call(Context& cxt, Simple_id& id, Expr_list& args)
+{
+  Overload_set* ovl = nullptr;
+  try {
+    ovl = &unqualified_lookup(cxt.current_scope(), id).set();
+  } catch (Lookup_error&) { }
+  if (ovl && !is_function_set(*ovl))
+    return build_function_call(cxt, make_reference(cxt, id), args);
+
+  Overload_set all;
+  for (Decl& d : argument_dependent_lookup(cxt, id, args)) {
+    if (!ovl || std::find(ovl->begin(), ovl->end(), &d) == ovl->end())
+      all.push_back(&d);
+  }
+  if (all.empty()) {
+    if (!ovl)
+      throw Lookup_error("no matching declaration for '{}'", id);
+    if (ovl->size() == 1 && is<Function_decl>(ovl->front()))
+      return build_function_call(cxt, make_reference(cxt, id), args);
+    return build_function_call(cxt, *ovl, args);
+  }
+  if (ovl)
+    all.insert(all.begin(), ovl->begin(), ovl->end());
+  return build_function_call(cxt, all, args);
+}
+
+
+// Build a call to the qualified function name `id`. The candidates
+// are found by qualified lookup in the nominated scope.
+inline Expr&
+build_qualified_call(Context& cxt, Qualified_id& id, Expr_list& args)
+{
+  if (Simple_id* n = as<Simple_id>(&id.name())) {
+    Overload_view decls = qualified_lookup(id.scope(), *n);
+    if (decls.size() > 1 || is<Template_decl>(&decls.front()))
+      return build_function_call(cxt, decls.set(), args);
+  }
+  return build_function_call(cxt, make_reference(cxt, id), args);
+}
+
+
+// Build a call to the function named by `n`. If `n` names an overload
+// set, the call is resolved by overload resolution. Otherwise, the
+// name is resolved as an id-expression, and the result is called.
+Expr&
+build_function_call(Context& cxt, Name& n, Expr_list& args)
+{
+  if (Simple_id* id = as<Simple_id>(&n))
+    return build_unqualified_call(cxt, *id, args);
+  if (Qualified_id* id = as<Qualified_id>(&n))
+    return build_qualified_call(cxt, *id, args);
+  return build_function_call(cxt, make_reference(cxt, n), args);
+}
+
+
 } // namespace banjo
@@ -12,6 +12,7 @@ namespace banjo
 {
 
 struct Context;
+struct Overload_set;
 
 
 // Represeents a candidate for overload resolution.
@@ -39,6 +40,9 @@ struct Function_candidate
 
 
 Expr& build_function_call(Context&, Function_decl&, Expr_list&);
+Expr& build_function_call(Context&, Overload_set&, Expr_list&);
+Expr& build_function_call(Context&, Expr&, Expr_list&);
+Expr& build_function_call(Context&, Name&, Expr_list&);
 
 
 } // namespace banjo
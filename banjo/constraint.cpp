@@ -16,13 +16,94 @@
 namespace banjo
 {
 
+// Returns the normalized definition of the concept `d`. The
+// definition is normalized once, and the result is saved with
+// the declaration. Its atoms are written in terms of the concept's
+// template parameters.
+Cons&
+normalize_definition(Context& cxt, Concept_decl& d)
+{
+  if (d.cons)
+    return *d.cons;
+
+  Def& def = d.definition();
+  if (Expression_def* expr = as<Expression_def>(&def)) {
+    d.cons = &normalize(cxt, expr->expression());
+    return *d.cons;
+  }
+  banjo_unhandled_case(def);
+}
+
+
+// Accumulate the properties of the constraint `c` into `p`. The
+// constraint is nested within `d` disjunctions. Concept checks are
+// counted, but not expanded.
+void
+accumulate_properties(Cons const& c, int d, Constraint_props& p)
+{
+  if (Conjunction_cons const* k = as<Conjunction_cons>(&c)) {
+    accumulate_properties(k->left(), d, p);
+    accumulate_properties(k->right(), d, p);
+  } else if (Disjunction_cons const* k = as<Disjunction_cons>(&c)) {
+    p.depth = std::max(p.depth, d + 1);
+    accumulate_properties(k->left(), d + 1, p);
+    accumulate_properties(k->right(), d + 1, p);
+  } else if (Parameterized_cons const* k = as<Parameterized_cons>(&c)) {
+    accumulate_properties(k->constraint(), d, p);
+  } else if (is<Concept_cons>(&c)) {
+    ++p.checks;
+  } else {
+    ++p.atoms;
+  }
+}
+
+
+// Returns the properties of the normalized constraint `c`.
+Constraint_props
+get_constraint_properties(Cons const& c)
+{
+  Constraint_props p {0, 0, 0, true};
+  accumulate_properties(c, 0, p);
+  return p;
+}
+
+
+// Returns the properties of the normalized definition of `d`.
+// These are computed once.
+Constraint_props const&
+get_concept_properties(Context& cxt, Concept_decl& d)
+{
+  if (!d.props.known)
+    d.props = get_constraint_properties(normalize_definition(cxt, d));
+  return d.props;
+}
+
+
+Constraint_props const&
+get_concept_properties(Context& cxt, Concept_decl const& d)
+{
+  return get_concept_properties(cxt, const_cast<Concept_decl&>(d));
+}
+
+
 // Expand the concept by substituting the template arguments
-// throughthe concept's definition and normalizing the result.
+// through the concept's normalized definition. Substitution into
+// a normalized constraint yields a normalized constraint, so the
+// result is not normalized again.
 //
-// TODO: Memoize the expansions.
+// Expansions are memoized. Because constraints are unique, each
+// distinct check of a concept is expanded once. It is an error if
+// the expansion of `c` is already in progress.
 Cons&
 expand(Context& cxt, Concept_cons& c)
 {
+  Constraint_state& st = cxt.constraint_state();
+  auto iter = st.expansions.find(&c);
+  if (iter != st.expansions.end())
+    return *iter->second;
+
+  Enter_instantiation inst(cxt, c);
+
   Concept_decl& d = c.declaration();
   Decl_list& tparms = d.parameters();
   Term_list& targs = c.arguments();
@@ -32,12 +113,9 @@ expand(Context& cxt, Concept_cons& c)
   // a semantic requirement of the original check expression.
   Substitution sub(tparms, targs);
 
-  Def& def = d.definition();
-  if (Expression_def* expr = as<Expression_def>(&def)) {
-    Expr& e = substitute(cxt, expr->expression(), sub);
-    return normalize(cxt, e);
-  }
-  banjo_unhandled_case(def);
+  Cons& r = substitute(cxt, normalize_definition(cxt, d), sub);
+  st.expansions.emplace(&c, &r);
+  return r;
 }
 
 
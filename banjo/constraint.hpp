@@ -6,16 +6,41 @@
 
 #include "prelude.hpp"
 
+#include <unordered_map>
+
 namespace banjo
 {
 
 struct Cons;
 struct Concept_cons;
+struct Concept_decl;
+struct Constraint_props;
 struct Context;
 
 
-Cons&       expand(Context&, Concept_cons&);
-Cons const& expand(Context&, Concept_cons const&);
+// The constraint state of a context. Each concept constraint is
+// mapped to its expansion. The operands of conjunctions and
+// disjunctions are ordered by when they were first normalized.
+// Each atom formed by substitution is mapped to the atom it was
+// substituted from.
+struct Constraint_state
+{
+  using Expansion_map = std::unordered_map<Cons const*, Cons*>;
+  using Order_map = std::unordered_map<Cons const*, std::size_t>;
+  using Origin_map = std::unordered_map<Cons const*, Cons const*>;
+
+  Expansion_map expansions; // Expanded concepts
+  Order_map     order;      // Canonical order of constraints
+  Origin_map    origins;    // The pattern of each substituted atom
+};
+
+
+Cons&                   normalize_definition(Context&, Concept_decl&);
+Constraint_props        get_constraint_properties(Cons const&);
+Constraint_props const& get_concept_properties(Context&, Concept_decl&);
+Constraint_props const& get_concept_properties(Context&, Concept_decl const&);
+Cons&                   expand(Context&, Concept_cons&);
+Cons const&             expand(Context&, Concept_cons const&);
 
 } // namespace banjo
 
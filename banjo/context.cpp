@@ -5,16 +5,33 @@
 #include "ast.hpp"
 #include "builder.hpp"
 #include "scope.hpp"
+#include "lookup.hpp"
+#include "conversion.hpp"
+#include "substitution.hpp"
+#include "template.hpp"
+#include "constraint.hpp"
+#include "subsumption.hpp"
+#include "satisfaction.hpp"
 #include "token.hpp"
+#include "print.hpp"
 
 #include <lingo/io.hpp>
 
+#include <sstream>
+
 
 namespace banjo
 {
 
 Context::Context()
-  : syms()
+  : syms(), classes(0),
+    lookups(new Lookup_state()),
+    convs(new Conversion_state()),
+    substs(new Substitution_state()),
+    tmps(new Template_state()),
+    conss(new Constraint_state()),
+    subs(new Subsumption_state()),
+    sats(new Satisfaction_state())
 {
   // Initialize the color system. This is a process-level
   // configuration. Perhaps we we should only initialize
@@ -31,6 +48,10 @@ Context::Context()
 }
 
 
+Context::~Context()
+{ }
+
+
 // -------------------------------------------------------------------------- //
 // Scope management
 
@@ -110,6 +131,19 @@ Enter_scope::Enter_scope(Context& c, Namespace_decl& ns)
 }
 
 
+// Enter the scope associated with a class definition. If the class
+// scope is not yet enclosed by another, it is enclosed by the scope
+// in which the class is defined.
+Enter_scope::Enter_scope(Context& c, Class_decl& cls)
+  : cxt(c), prev(&c.current_scope()), alloc(nullptr)
+{
+  Scope& s = *cls.scope();
+  if (!s.enclosing_scope())
+    s.parent = prev;
+  cxt.set_scope(s);
+}
+
+
 // Enter the given scope. This assumes ownership of the given
 // scope and deletes it when the class goes out of scope.
 Enter_scope::Enter_scope(Context& c, Scope& s)
@@ -127,4 +161,48 @@ Enter_scope::~Enter_scope()
 }
 
 
+// -------------------------------------------------------------------------- //
+// Enter instantiation
+
+// Returns a description of the instantiations in progress,
+// innermost first.
+inline std::string
+instantiation_backtrace(Context const& cxt)
+{
+  Template_state const& st = cxt.template_state();
+  std::stringstream ss;
+  for (auto iter = st.insts.rbegin(); iter != st.insts.rend(); ++iter)
+    ss << "\n  required by '" << **iter << "'";
+  return ss.str();
+}
+
+
+// Enter the instantiation identified by `t`.
+Enter_instantiation::Enter_instantiation(Context& c, Term const& t)
+  : cxt(c)
+{
+  Template_state& st = cxt.template_state();
+  if (st.active.count(&t)) {
+    std::string bt = instantiation_backtrace(cxt);
+    throw Instantiation_error("recursive instantiation of '{}'{}", t, bt);
+  }
+  if (st.insts.size() >= st.limit) {
+    std::string bt = instantiation_backtrace(cxt);
+    throw Limitation_error("instantiation of '{}' exceeds the maximum depth of {}{}",
+                           t, st.limit, bt);
+  }
+  st.insts.push_back(&t);
+  st.active.insert(&t);
+}
+
+
+// Leave the current instantiation.
+Enter_instantiation::~Enter_instantiation()
+{
+  Template_state& st = cxt.template_state();
+  st.active.erase(st.insts.back());
+  st.insts.pop_back();
+}
+
+
 } // namespace banjo
@@ -6,6 +6,8 @@
 
 #include "prelude.hpp"
 
+#include <memory>
+
 
 namespace banjo
 {
@@ -14,7 +16,16 @@ struct Decl;
 struct Variable_decl;
 struct Function_decl;
 struct Namespace_decl;
+struct Class_decl;
+struct Term;
 struct Scope;
+struct Lookup_state;
+struct Conversion_state;
+struct Substitution_state;
+struct Template_state;
+struct Constraint_state;
+struct Subsumption_state;
+struct Satisfaction_state;
 
 
 // A repository of information to support translation.
@@ -27,6 +38,7 @@ struct Scope;
 struct Context
 {
   Context();
+  ~Context();
 
   // Non-copyable
   Context(Context const&) = delete;
@@ -49,9 +61,35 @@ struct Context
   Scope& current_scope();
   Decl&  current_context();
 
-  Symbol_table    syms;
-  Namespace_decl* global; // The global namespace
-  Scope*          scope;  // The current scope.
+  // Returns the state of each subsystem. The state is declared in
+  // the header of that subsystem.
+  Lookup_state const&       lookup_state() const       { return *lookups; }
+  Lookup_state&             lookup_state()             { return *lookups; }
+  Conversion_state const&   conversion_state() const   { return *convs; }
+  Conversion_state&         conversion_state()         { return *convs; }
+  Substitution_state const& substitution_state() const { return *substs; }
+  Substitution_state&       substitution_state()       { return *substs; }
+  Template_state const&     template_state() const     { return *tmps; }
+  Template_state&           template_state()           { return *tmps; }
+  Constraint_state const&   constraint_state() const   { return *conss; }
+  Constraint_state&         constraint_state()         { return *conss; }
+  Subsumption_state const&  subsumption_state() const  { return *subs; }
+  Subsumption_state&        subsumption_state()        { return *subs; }
+  Satisfaction_state const& satisfaction_state() const { return *sats; }
+  Satisfaction_state&       satisfaction_state()       { return *sats; }
+
+  Symbol_table     syms;
+  Namespace_decl*  global;  // The global namespace
+  Scope*           scope;   // The current scope.
+  std::size_t      classes; // The number of classes created
+
+  std::unique_ptr<Lookup_state>       lookups; // Lookup state
+  std::unique_ptr<Conversion_state>   convs;   // Conversion state
+  std::unique_ptr<Substitution_state> substs;  // Substitution state
+  std::unique_ptr<Template_state>     tmps;    // Template state
+  std::unique_ptr<Constraint_state>   conss;   // Constraint state
+  std::unique_ptr<Subsumption_state>  subs;    // Subsumption state
+  std::unique_ptr<Satisfaction_state> sats;    // Satisfaction state
 };
 
 
@@ -59,6 +97,7 @@ struct Context
 struct Enter_scope
 {
   Enter_scope(Context&, Namespace_decl&);
+  Enter_scope(Context&, Class_decl&);
   Enter_scope(Context&, Scope&);
   ~Enter_scope();
 
@@ -68,6 +107,22 @@ struct Enter_scope
 };
 
 
+// An RAII helper that records the instantiation of a specialization
+// or the expansion of a concept for the duration of its lifetime.
+// The term `t` identifies the instantiation, and must be unique
+// (e.g., a template-id or a concept constraint).
+//
+// Entering an instantiation that is already in progress is an
+// error, as is exceeding the instantiation depth limit.
+struct Enter_instantiation
+{
+  Enter_instantiation(Context&, Term const&);
+  ~Enter_instantiation();
+
+  Context& cxt;
+};
+
+
 } // namespace banjo
 
 
@@ -580,47 +580,180 @@ get_conversion_sequence(Expr const& e)
 // Ordering of conversion sequences
 
 
-// FIXME: Finish implementing this.
-Conversion_comp
-compare(Standard_conversion_seq const& s1, Standard_conversion_seq const& s2)
+// Returns the rank of a standard conversion sequence. A sequence
+// that applies no value conversion has exact rank. Conversions of
+// bool to integer, of integers to wider integers of the same sign,
+// and of floats to wider floats are promotions. All other value
+// conversions have conversion rank.
+Conversion_rank
+get_conversion_rank(Standard_conversion_seq const& seq)
 {
-  // If s1 is a proper subsequence of s2.
-  // TODO: How is a subsequence defined?
+  struct fn
+  {
+    Conversion_rank operator()(Expr const&)
+    {
+      return conversion_rank;
+    }
+
+    Conversion_rank operator()(Integer_conv const& c)
+    {
+      Type const& s = c.source().type();
+      Integer_type const& t = cast<Integer_type>(c.destination());
+      if (is<Boolean_type>(&s))
+        return promotion_rank;
+      if (Integer_type const* z = as<Integer_type>(&s))
+        if (z->sign() == t.sign() && z->precision() < t.precision())
+          return promotion_rank;
+      return conversion_rank;
+    }
+
+    Conversion_rank operator()(Float_conv const& c)
+    {
+      Type const& s = c.source().type();
+      Float_type const& t = cast<Float_type>(c.destination());
+      if (Float_type const* z = as<Float_type>(&s))
+        if (z->precision() < t.precision())
+          return promotion_rank;
+      return conversion_rank;
+    }
+  };
+
+  if (Conv const* c = seq.conversion())
+    return apply(*c, fn{});
+  return exact_rank;
+}
 
-  // or s1 is better than s2 according to some rules...
 
-  // ... some stuff about refernce bindings
-  return indistinct_conv;
+// Returns the implicit conversion described by the conversion
+// sequence `seq`.
+Implicit_conversion
+get_implicit_conversion(Conversion_seq const& seq)
+{
+  Implicit_conversion ic;
+  ic.viable = true;
+  ic.kind = seq.kind();
+  if (seq.kind() == std_conv_seq) {
+    Standard_conversion_seq s = seq.standard_conversions();
+    ic.rank = get_conversion_rank(s);
+    ic.conv = s.conversion();
+    ic.adjust = s.adjustment();
+  }
+  return ic;
 }
 
 
+// Returns the conversion applied by the initializer `e`.
+inline Expr&
+get_initializing_expression(Expr& e)
+{
+  if (Copy_init* i = as<Copy_init>(&e))
+    return i->expression();
+  if (Bind_init* i = as<Bind_init>(&e))
+    return i->expression();
+  return e;
+}
+
+
+// Returns the implicit conversion needed to copy-initialize an object
+// or reference of type `t` from the expression `e`.
+//
+// The result depends only on the type of `e` and on `t`, so it is
+// computed once for each pair of types and saved in the context.
+// Types are compared structurally.
+//
+// TODO: This will not be the case when we support conversions that
+// depend on the value of the expression (e.g., null pointer
+// constants).
+Implicit_conversion
+get_implicit_conversion(Context& cxt, Expr& e, Type& t)
+{
+  Conversion_map& memo = cxt.conversion_state().memo;
+  Type_pair key {&e.type(), &t};
+  auto iter = memo.find(key);
+  if (iter != memo.end())
+    return iter->second;
+
+  Implicit_conversion ic;
+  try {
+    Expr& init = copy_initialize(cxt, t, e);
+    Expr& conv = get_initializing_expression(init);
+    ic = get_implicit_conversion(get_conversion_sequence(conv));
+  } catch (Internal_error&) {
+    throw;
+  } catch (std::runtime_error&) {
+    // The conversion is not viable.
+  }
+  memo.emplace(key, ic);
+  return ic;
+}
+
 
+// Compare two standard conversion sequences.
 Conversion_comp
-compare(Conversion_seq const& a, Conversion_seq const& b)
+compare(Standard_conversion_seq const& s1, Standard_conversion_seq const& s2)
+{
+  return compare(get_implicit_conversion(s1), get_implicit_conversion(s2));
+}
+
+
+// Compare two implicit conversions. Each conversion must be viable.
+//
+// A standard conversion sequence s1 is better than s2 if:
+//
+//    - s1 is a proper subsequence of s2, excluding any value
+//      transformation (the identity sequence is a subsequence
+//      of any non-identity sequence), or
+//    - the rank of s1 is better than the rank of s2.
+//
+// TODO: Implement the rules for reference bindings and
+// qualification conversions.
+Conversion_comp
+compare(Implicit_conversion const& a, Implicit_conversion const& b)
 {
   // A standad conversion sequence is better then a user-define
   // conversion sequence and an ellipsis conversion sequence.
-  if (a.kind() == std_conv_seq && b.kind() != std_conv_seq)
+  if (a.kind == std_conv_seq && b.kind != std_conv_seq)
     return better_conv;
-  if (b.kind() == std_conv_seq && a.kind() != std_conv_seq)
+  if (b.kind == std_conv_seq && a.kind != std_conv_seq)
     return worse_conv;
 
   // A user-defined conversion sequence is better than an ellipsis
   // conversion sequence.
-  if (a.kind() == user_conv_seq && b.kind() == ellipsis_conv_seq)
+  if (a.kind == user_conv_seq && b.kind == ellipsis_conv_seq)
+    return better_conv;
+  if (b.kind == user_conv_seq && a.kind == ellipsis_conv_seq)
+    return worse_conv;
+
+  // We cannot distinguish other kinds of conversion sequences.
+  if (a.kind != std_conv_seq)
+    return indistinct_conv;
+
+  // Check for proper subsequences.
+  bool sub1 = a.conv <= b.conv && a.adjust <= b.adjust;
+  bool sub2 = b.conv <= a.conv && b.adjust <= a.adjust;
+  if (sub1 && !sub2)
     return better_conv;
-  if (b.kind() == user_conv_seq && a.kind() == ellipsis_conv_seq)
+  if (sub2 && !sub1)
     return worse_conv;
 
-  // Distinguish between converison sequences of the same kind.
-  if (a.kind() == std_conv_seq && b.kind() == std_conv_seq)
-    return compare(a.standard_conversions(), b.standard_conversions());
+  // Compare by rank.
+  if (a.rank < b.rank)
+    return better_conv;
+  if (b.rank < a.rank)
+    return worse_conv;
 
-  // We cannot distinguis the conversion sequences.
   return indistinct_conv;
 }
 
 
+// Compare two conversion sequences.
+Conversion_comp
+compare(Conversion_seq const& a, Conversion_seq const& b)
+{
+  return compare(get_implicit_conversion(a), get_implicit_conversion(b));
+}
+
+
 // -------------------------------------------------------------------------- //
 // Contextual conversions
 
@@ -6,6 +6,10 @@
 
 #include "prelude.hpp"
 #include "ast.hpp"
+#include "hash.hpp"
+#include "equivalence.hpp"
+
+#include <unordered_map>
 
 
 namespace banjo
@@ -187,6 +191,68 @@ enum Conversion_comp
 };
 
 
+// An implicit conversion describes the conversion sequence needed
+// to convert a value of one type to another, independently of the
+// expression being converted. This is sufficient to determine whether
+// the conversion is possible and to rank it against other conversions.
+//
+// Implicit conversions are memoized by the context (see
+// get_implicit_conversion).
+struct Implicit_conversion
+{
+  Implicit_conversion()
+    : viable(false), kind(std_conv_seq), rank(exact_rank)
+    , conv(false), adjust(false)
+  { }
+
+  bool                viable; // True if the conversion is possible
+  Conversion_seq_kind kind;   // The kind of conversion sequence
+  Conversion_rank     rank;   // The rank of a standard conversion
+  bool                conv;   // True if a value conversion is applied
+  bool                adjust; // True if a qualification is adjusted
+};
+
+
+// A pair of types, hashed and compared by their structure.
+using Type_pair = std::pair<Type const*, Type const*>;
+
+
+struct Type_pair_hash
+{
+  std::size_t operator()(Type_pair const& p) const
+  {
+    std::size_t h = hash_value(*p.first);
+    boost::hash_combine(h, hash_value(*p.second));
+    return h;
+  }
+};
+
+
+struct Type_pair_eq
+{
+  bool operator()(Type_pair const& a, Type_pair const& b) const
+  {
+    return is_equivalent(*a.first, *b.first)
+        && is_equivalent(*a.second, *b.second);
+  }
+};
+
+
+// Maps (source, destination) type pairs to implicit conversions.
+using Conversion_map = std::unordered_map<
+  Type_pair, Implicit_conversion, Type_pair_hash, Type_pair_eq
+>;
+
+
+// The conversion state of a context. Implicit conversions are
+// memoized for each pair of source and destination types (see
+// get_implicit_conversion).
+struct Conversion_state
+{
+  Conversion_map memo; // Implicit conversions between types
+};
+
+
 // FIXME: All of these should take a context.
 
 Expr&     standard_conversion(Expr const&, Type const&);
@@ -196,8 +262,13 @@ Expr& contextual_conversion_to_bool(Context& cxt, Expr&);
 
 Conversion_seq get_conversion_sequence(Expr const&);
 
+Conversion_rank     get_conversion_rank(Standard_conversion_seq const&);
+Implicit_conversion get_implicit_conversion(Conversion_seq const&);
+Implicit_conversion get_implicit_conversion(Context&, Expr&, Type&);
+
 Conversion_comp compare(Conversion_seq const&, Conversion_seq const&);
 Conversion_comp compare(Standard_conversion_seq const&, Standard_conversion_seq const&);
+Conversion_comp compare(Implicit_conversion const&, Implicit_conversion const&);
 
 bool is_similar(Type const&, Type const&);
 Qualifier_list get_qualification_signature(Type const&);
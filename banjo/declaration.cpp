@@ -13,16 +13,25 @@
 namespace banjo
 {
 
-// Save `d` as a new declaration in the given overload set.
+// Save `d` as a new declaration in the given overload set. If `d`
+// redeclares a function in the set, that declaration is returned,
+// and `d` is not added. Otherwise, this returns nullptr.
 //
-// TODO: Implement me.
-//
-// TODO: Actually check for overloading and re-definition
-// errors.
+// TODO: Check for re-definition errors and conflicting
+// specifiers in redeclarations.
 Decl*
 declare(Overload_set& ovl, Decl& d)
 {
-  lingo_unimplemented();
+  for (Decl* prev : ovl) {
+    if (can_overload(d, *prev))
+      continue;
+    if (is<Function_decl>(&d.parameterized_declaration()) &&
+        is<Function_decl>(&prev->parameterized_declaration()))
+      return prev;
+    throw Translation_error("'{}' conflicts with a previous declaration",
+                            d.name());
+  }
+  ovl.push_back(&d);
   return nullptr;
 }
 
@@ -98,6 +107,10 @@ declare(Context&, Scope& scope, Decl& decl)
   // Find an appropriate declartive region for the declaration.
   Scope& s = adjust_scope(scope, decl);
 
+  // Template parameters are indexed by their declaration.
+  if (Template_parameter_scope* ps = as<Template_parameter_scope>(&s))
+    parameter_index(decl).pair() = {ps->depth(), ps->count++};
+
   // Declare the ajusted declaration.
   if (Overload_set* ovl = s.lookup(decl.declared_name())) {
     return banjo::declare(*ovl, decl);
@@ -6,12 +6,113 @@
 #include "equivalence.hpp"
 #include "print.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 
 namespace banjo
 {
 
+// -------------------------------------------------------------------------- //
+// Type shapes
+//
+// The shape of a type records the kinds of type constructors along
+// its spine (e.g., pointer to reference to int). Deduction can only
+// succeed when the shape of the parameter type matches a prefix of
+// the shape of the argument type. Placeholders and template parameters
+// leave the remainder of the shape unconstrained (open).
+//
+// Function types are also open since their spine does not cover
+// their parameter types.
+
+
+// The maximum number of constructors recorded in a shape.
+constexpr int max_shape = 16;
+
+
+// Compute the shape of a type.
+Type_shape
+compute_shape(Type const& t)
+{
+  struct fn
+  {
+    Type_shape leaf(int k)      { return {std::uint64_t(k), 1, false}; }
+    Type_shape wild()           { return {0, 0, true}; }
+    Type_shape open(int k)      { return {std::uint64_t(k), 1, true}; }
+
+    // Add a constructor of kind k to the shape of t.
+    Type_shape node(int k, Type const& t)
+    {
+      Type_shape s = get_shape(t);
+      s.kinds = (s.kinds << 4) | k;
+      if (s.len == max_shape)
+        s.open = true;
+      else
+        ++s.len;
+      return s;
+    }
+
+    Type_shape operator()(Type const& t)           { return open(15); }
+    Type_shape operator()(Void_type const& t)      { return leaf(1); }
+    Type_shape operator()(Boolean_type const& t)   { return leaf(2); }
+    Type_shape operator()(Byte_type const& t)      { return leaf(3); }
+    Type_shape operator()(Integer_type const& t)   { return leaf(4); }
+    Type_shape operator()(Float_type const& t)     { return leaf(5); }
+    Type_shape operator()(Class_type const& t)     { return leaf(6); }
+    Type_shape operator()(Union_type const& t)     { return leaf(7); }
+    Type_shape operator()(Enum_type const& t)      { return leaf(8); }
+    Type_shape operator()(Synthetic_type const& t) { return leaf(9); }
+    Type_shape operator()(Function_type const& t)  { return open(10); }
+    Type_shape operator()(Qualified_type const& t) { return node(11, t.type()); }
+    Type_shape operator()(Pointer_type const& t)   { return node(12, t.type()); }
+    Type_shape operator()(Reference_type const& t) { return node(13, t.type()); }
+    Type_shape operator()(Array_type const& t)     { return node(14, t.type()); }
+    Type_shape operator()(Sequence_type const& t)  { return node(15, t.type()); }
+    Type_shape operator()(Auto_type const& t)      { return wild(); }
+    Type_shape operator()(Decltype_type const& t)  { return wild(); }
+    Type_shape operator()(Declauto_type const& t)  { return wild(); }
+    Type_shape operator()(Typename_type const& t)  { return wild(); }
+  };
+  return apply(t, fn{});
+}
+
+
+// Returns the shape of a type, computing it if needed.
+Type_shape const&
+get_shape(Type const& t)
+{
+  if (t.shape.len < 0)
+    t.shape = compute_shape(t);
+  return t.shape;
+}
+
+
+// Returns false if a parameter type with shape `p` cannot be
+// deduced from an argument type with shape `a`. Note that this
+// does not guarantee that deduction will succeed.
+bool
+may_deduce(Type_shape const& p, Type_shape const& a)
+{
+  // The shared prefix must have the same constructors.
+  int n = std::min(p.len, a.len);
+  std::uint64_t mask = n == max_shape ? ~std::uint64_t(0)
+                                      : (std::uint64_t(1) << (4 * n)) - 1;
+  if ((p.kinds ^ a.kinds) & mask)
+    return false;
+
+  // If neither is open, the shapes must be the same.
+  if (!p.open && !a.open)
+    return p.len == a.len;
+
+  // An open shape matches any extension of its prefix.
+  if (!p.open)
+    return p.len >= a.len;
+  if (!a.open)
+    return a.len >= p.len;
+  return true;
+}
+
+
 // -------------------------------------------------------------------------- //
 // Deducing template arguments from a type
 
@@ -44,6 +145,19 @@ deduce_from_type(Pointer_type& p, Type& a, Substitution& sub)
 }
 
 
+// Deduce arguments when both types have the form T[N]. This deduces
+// from both the element type and the extent.
+bool
+deduce_from_type(Array_type& p, Type& a, Substitution& sub)
+{
+  if (Array_type* t = as<Array_type>(&a)) {
+    return deduce_from_type(p.type(), t->type(), sub)
+        && deduce_from_value(p.extent(), t->extent(), sub);
+  }
+  return false;
+}
+
+
 // Deduce arguments when both types have the form T[].
 //
 // Note that this form of deduction is not available in C++ since
@@ -57,6 +171,24 @@ deduce_from_type(Sequence_type& p, Type& a, Substitution& sub)
 }
 
 
+// Deduce arguments from function types having the same number of
+// parameters. This deduces from each parameter type and from the
+// return type.
+bool
+deduce_from_type(Function_type& p, Type& a, Substitution& sub)
+{
+  if (Function_type* t = as<Function_type>(&a)) {
+    Type_list& ps = p.parameter_types();
+    Type_list& as = t->parameter_types();
+    if (ps.size() != as.size())
+      return false;
+    return deduce_from_types(ps, as, sub)
+        && deduce_from_type(p.return_type(), t->return_type(), sub);
+  }
+  return false;
+}
+
+
 // Deduce an assignment of a type parrameter to a corresponding
 // argument type. For example, given
 //
@@ -82,15 +214,19 @@ deduce_from_type(Typename_type& p, Type& a, Substitution& sub)
     }
     return true;
   }
-  return false;
+
+  // A parameter that is not being deduced only matches itself.
+  return is_equivalent(p, a);
 }
 
 
 // Find a substitution from template parameters in `p` to template
-// arguments in `a`.
+// arguments in `a`. This unifies the two types, mapping parameters
+// in `p` to the corresponding parts of `a`.
 //
-// TODO: This is clearly incomplete. Finish implementing template
-// argument deduction.
+// Non-dependent parts of `p` must be equivalent to the corresponding
+// parts of `a`. Placeholder types and decltype types are non-deduced
+// contexts and match any argument.
 //
 // TODO: For any templated type, we need to perform unification
 // against their respective ids.
@@ -102,24 +238,53 @@ deduce_from_type(Type& p, Type& a, Substitution& sub)
     Type& a;
     Substitution& sub;
 
-    // We can't deduce from most type patterns.
-    bool operator()(Type& p)           { return true; }
-
-    bool operator()(Auto_type& p)      { lingo_unimplemented(); }
-    bool operator()(Decltype_type& p)  { lingo_unimplemented(); }
-    bool operator()(Declauto_type& p)  { lingo_unimplemented(); }
-    bool operator()(Function_type& p)  { lingo_unimplemented(); }
+    bool operator()(Type& p)           { return is_equivalent(p, a); }
+    bool operator()(Auto_type& p)      { return true; }
+    bool operator()(Decltype_type& p)  { return true; }
+    bool operator()(Declauto_type& p)  { return true; }
+    bool operator()(Function_type& p)  { return deduce_from_type(p, a, sub); }
     bool operator()(Reference_type& p) { return deduce_from_type(p, a, sub); }
     bool operator()(Qualified_type& p) { return deduce_from_type(p, a, sub); }
     bool operator()(Pointer_type& p)   { return deduce_from_type(p, a, sub); }
-    bool operator()(Array_type& p)     { lingo_unimplemented(); }
+    bool operator()(Array_type& p)     { return deduce_from_type(p, a, sub); }
     bool operator()(Sequence_type& p)  { return deduce_from_type(p, a, sub); }
     bool operator()(Typename_type& p)  { return deduce_from_type(p, a, sub); }
   };
+
+  // Quickly reject types whose shapes do not match.
+  if (!may_deduce(get_shape(p), get_shape(a)))
+    return false;
+
+  // There is nothing to deduce from non-dependent types.
+  if (!is_dependent(p))
+    return is_equivalent(p, a);
+
   return apply(p, fn{a, sub});
 }
 
 
+// -------------------------------------------------------------------------- //
+// Deducing template arguments from a value
+
+// Deduce an assignment of a value parameter from an expression
+// (e.g., the extent of an array type). If `p` does not name a
+// value parameter, then the expressions must be equivalent.
+bool
+deduce_from_value(Expr& p, Expr& a, Substitution& sub)
+{
+  if (Reference_expr* r = as<Reference_expr>(&p)) {
+    Decl& d = r->declaration();
+    if (is<Value_parm>(&d) && sub.has_mapping(d)) {
+      if (Expr* e = as<Expr>(sub.get_mapping(d)))
+        return is_equivalent(a, *e);
+      sub.map_to(d, a);
+      return true;
+    }
+  }
+  return is_equivalent(p, a);
+}
+
+
 // Deduce a template arguments from a list of parameters and arguments.
 // This succeeds only when deduction succeds for each parameter and
 // argument in the corresponding lists.
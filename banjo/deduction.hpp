@@ -24,6 +24,10 @@ struct Deduction_failure : Translation_error
 
 bool deduce_from_type(Type&, Type&, Substitution&);
 bool deduce_from_types(Type_list&, Type_list&, Substitution&);
+bool deduce_from_value(Expr&, Expr&, Substitution&);
+
+Type_shape const& get_shape(Type const&);
+bool              may_deduce(Type_shape const&, Type_shape const&);
 
 void deduce_from_call(Type&, Type&, Substitution&);
 void deduce_from_address(Type&, Type&, Substitution&);
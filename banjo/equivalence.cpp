@@ -47,6 +47,12 @@ is_equivalent(Term const& x1, Term const& x2)
 }
 
 
+bool
+Term_list_eq::operator()(Term_list const& a, Term_list const& b) const
+{
+  return is_equivalent(a, b);
+}
+
 
 // -------------------------------------------------------------------------- //
 // Names
@@ -105,14 +111,14 @@ is_equivalent(Destructor_id const& n1, Destructor_id const& n2)
 inline bool
 is_equivalent(Template_id const& n1, Template_id const& n2)
 {
-  lingo_unimplemented();
+  return n1.decl == n2.decl && is_equivalent(n1.arguments(), n2.arguments());
 }
 
 
 inline bool
 is_equivalent(Concept_id const& n1, Concept_id const& n2)
 {
-  lingo_unimplemented();
+  return n1.decl == n2.decl && is_equivalent(n1.arguments(), n2.arguments());
 }
 
 
@@ -237,11 +243,11 @@ is_equivalent(Pointer_type const& t1, Pointer_type const& t2)
 }
 
 
-// TODO: The extent of the arrays must be equivalent.
 bool
-is_equivalent(Array_type const&, Array_type const&)
+is_equivalent(Array_type const& t1, Array_type const& t2)
 {
-  lingo_unimplemented();
+  return is_equivalent(t1.type(), t2.type())
+      && is_equivalent(t1.extent(), t2.extent());
 }
 
 
@@ -20,6 +20,9 @@ struct Expr;
 struct Decl;
 struct Cons;
 
+template<typename T> struct List;
+using Term_list = List<Term>;
+
 
 bool is_equivalent(Term const&, Term const&);
 bool is_equivalent(Name const&, Name const&);
@@ -47,6 +50,13 @@ using Decl_eq = Term_eq<Decl>;
 using Cons_eq = Term_eq<Cons>;
 
 
+// Equality comparison for lists of terms (e.g., template arguments).
+struct Term_list_eq
+{
+  bool operator()(Term_list const&, Term_list const&) const;
+};
+
+
 } // namespace banjo
 
 #endif
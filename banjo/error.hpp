@@ -87,6 +87,14 @@ struct Evaluation_error : Translation_error
 };
 
 
+// Represents an error in the instantiation of a template or the
+// expansion of a concept (e.g., infinitely recursive instantiation).
+struct Instantiation_error : Translation_error
+{
+  using Translation_error::Translation_error;
+};
+
+
 // Represents an error caused by exceeding an implementation limit.
 struct Limitation_error : Translation_error
 {
@@ -4,6 +4,7 @@
 #include "evaluation.hpp"
 #include "ast.hpp"
 #include "builder.hpp"
+#include "template.hpp"
 #include "print.hpp"
 
 #include <iostream>
@@ -317,6 +318,9 @@ Evaluator::elaborate_object(Object_decl const& d)
 Expr&
 reduce(Context& cxt, Expr& e)
 {
+  // Evaluation may require the definitions of specializations.
+  instantiate_pending(cxt);
+
   struct fn
   {
     fn(Context& c, Type& t)
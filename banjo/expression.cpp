@@ -57,7 +57,24 @@ make_reference(Context& cxt, Decl& d)
 Expr&
 make_reference(Context& cxt, Simple_id& id)
 {
-  Decl_list decls = unqualified_lookup(cxt.current_scope(), id);
+  Overload_view decls = unqualified_lookup(cxt.current_scope(), id);
+  if (decls.size() == 1)
+    return make_reference(cxt, decls.front());
+
+  // TODO: Return a reference to an overload set.
+  banjo_unhandled_case(id);
+}
+
+
+// Perform qualified lookup in the scope nominated by the id.
+Expr&
+make_reference(Context& cxt, Qualified_id& id)
+{
+  Simple_id* n = as<Simple_id>(&id.name());
+  if (!n)
+    banjo_unhandled_case(id.name());
+
+  Overload_view decls = qualified_lookup(id.scope(), *n);
   if (decls.size() == 1)
     return make_reference(cxt, decls.front());
 
@@ -80,6 +97,7 @@ make_reference(Context& cxt, Template_id& id)
   Template_decl& tmp = id.declaration();
   Term_list& args = id.arguments();
   Decl& d = specialize_template(cxt, tmp, args);
+  request_instantiation(cxt, d);
   return make_reference(cxt, d);
 }
 
@@ -110,10 +128,11 @@ make_reference(Context& cxt, Name& n)
   struct fn
   {
     Context& cxt;
-    Expr& operator()(Name& n)        { banjo_unhandled_case(n); }
-    Expr& operator()(Simple_id& n)   { return make_reference(cxt, n); }
-    Expr& operator()(Template_id& n) { return make_reference(cxt, n); }
-    Expr& operator()(Concept_id& n)  { return make_reference(cxt, n); }
+    Expr& operator()(Name& n)         { banjo_unhandled_case(n); }
+    Expr& operator()(Simple_id& n)    { return make_reference(cxt, n); }
+    Expr& operator()(Qualified_id& n) { return make_reference(cxt, n); }
+    Expr& operator()(Template_id& n)  { return make_reference(cxt, n); }
+    Expr& operator()(Concept_id& n)   { return make_reference(cxt, n); }
   };
   return apply(n, fn{cxt});
 }
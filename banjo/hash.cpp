@@ -72,16 +72,22 @@ hash_value(Destructor_id const&)
 
 
 inline std::size_t
-hash_value(Template_id const&)
+hash_value(Template_id const& n)
 {
-  lingo_unimplemented();
+  std::size_t h = hash_type(n);
+  boost::hash_combine(h, n.decl);
+  boost::hash_combine(h, Term_list_hash{}(n.arguments()));
+  return h;
 }
 
 
 inline std::size_t
-hash_value(Concept_id const&)
+hash_value(Concept_id const& n)
 {
-  lingo_unimplemented();
+  std::size_t h = hash_type(n);
+  boost::hash_combine(h, n.decl);
+  boost::hash_combine(h, Term_list_hash{}(n.arguments()));
+  return h;
 }
 
 
@@ -178,6 +184,71 @@ hash_value(Function_type const& t)
 }
 
 
+inline std::size_t
+hash_value(Qualified_type const& t)
+{
+  std::size_t h = hash_type(t);
+  boost::hash_combine(h, int(t.qualifier()));
+  boost::hash_combine(h, t.type());
+  return h;
+}
+
+
+inline std::size_t
+hash_value(Pointer_type const& t)
+{
+  std::size_t h = hash_type(t);
+  boost::hash_combine(h, t.type());
+  return h;
+}
+
+
+inline std::size_t
+hash_value(Reference_type const& t)
+{
+  std::size_t h = hash_type(t);
+  boost::hash_combine(h, t.type());
+  return h;
+}
+
+
+// TODO: Include the extent of the array.
+inline std::size_t
+hash_value(Array_type const& t)
+{
+  std::size_t h = hash_type(t);
+  boost::hash_combine(h, *t.first);
+  return h;
+}
+
+
+inline std::size_t
+hash_value(Sequence_type const& t)
+{
+  std::size_t h = hash_type(t);
+  boost::hash_combine(h, t.type());
+  return h;
+}
+
+
+inline std::size_t
+hash_value(User_defined_type const& t)
+{
+  std::size_t h = hash_type(t);
+  boost::hash_combine(h, t.declaration());
+  return h;
+}
+
+
+// Synthetic types are equivalent only when they are identical.
+inline std::size_t
+hash_value(Synthetic_type const& t)
+{
+  std::hash<Type const*> h;
+  return h(&t);
+}
+
+
 // Compute the hash value of a type.
 std::size_t
 hash_value(Type const& t)
@@ -192,16 +263,16 @@ hash_value(Type const& t)
     std::size_t operator()(Decltype_type const& t) const  { return hash_value(t); }
     std::size_t operator()(Declauto_type const& t) const  { return hash_value(t); }
     std::size_t operator()(Function_type const& t) const  { return hash_value(t); }
-    std::size_t operator()(Qualified_type const& t) const { lingo_unimplemented(); }
-    std::size_t operator()(Pointer_type const& t) const   { lingo_unimplemented(); }
-    std::size_t operator()(Reference_type const& t) const { lingo_unimplemented(); }
-    std::size_t operator()(Array_type const& t) const     { lingo_unimplemented(); }
-    std::size_t operator()(Sequence_type const& t) const  { lingo_unimplemented(); }
-    std::size_t operator()(Class_type const& t) const     { lingo_unimplemented(); }
-    std::size_t operator()(Union_type const& t) const     { lingo_unimplemented(); }
-    std::size_t operator()(Enum_type const& t) const      { lingo_unimplemented(); }
-    std::size_t operator()(Typename_type const& t) const  { lingo_unimplemented(); }
-    std::size_t operator()(Synthetic_type const& t) const { lingo_unimplemented(); }
+    std::size_t operator()(Qualified_type const& t) const { return hash_value(t); }
+    std::size_t operator()(Pointer_type const& t) const   { return hash_value(t); }
+    std::size_t operator()(Reference_type const& t) const { return hash_value(t); }
+    std::size_t operator()(Array_type const& t) const     { return hash_value(t); }
+    std::size_t operator()(Sequence_type const& t) const  { return hash_value(t); }
+    std::size_t operator()(Class_type const& t) const     { return hash_value(t); }
+    std::size_t operator()(Union_type const& t) const     { return hash_value(t); }
+    std::size_t operator()(Enum_type const& t) const      { return hash_value(t); }
+    std::size_t operator()(Typename_type const& t) const  { return hash_value(t); }
+    std::size_t operator()(Synthetic_type const& t) const { return hash_value(t); }
   };
   return apply(t, fn{});
 }
@@ -295,7 +366,7 @@ hash_value(Concept_cons const& c)
 {
   std::size_t h = hash_type(c);
   boost::hash_combine(h, c.declaration());
-  boost::hash_combine(h, c.arguments());
+  boost::hash_combine(h, Term_list_hash{}(c.arguments()));
   return h;
 }
 
@@ -334,4 +405,25 @@ hash_value(Cons const& c)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Term lists
+
+std::size_t
+Term_list_hash::operator()(Term_list const& ts) const
+{
+  std::size_t h = 0;
+  for (Term const& t : ts) {
+    if (Type const* x = as<Type>(&t))
+      boost::hash_combine(h, hash_value(*x));
+    else if (Expr const* x = as<Expr>(&t))
+      boost::hash_combine(h, hash_value(*x));
+    else if (Decl const* x = as<Decl>(&t))
+      boost::hash_combine(h, hash_value(*x));
+    else
+      lingo_unreachable();
+  }
+  return h;
+}
+
+
 } // namespace banjo
@@ -1,6 +1,9 @@
 // Copyright (c) 2015-2016 Andrew Sutton
 // All rights reserved
 
+#ifndef BANJO_HASH_HPP
+#define BANJO_HASH_HPP
+
 #include "prelude.hpp"
 #include "equivalence.hpp"
 
@@ -18,10 +21,12 @@ std::size_t hash_value(Decl const&);
 std::size_t hash_value(Cons const&);
 
 
+// Hash function for pointers to terms. This is used to index
+// unordered containers (e.g., scopes) by the structure of a term.
 template<typename T>
 struct Term_hash
 {
-  bool operator()(T const* t) const
+  std::size_t operator()(T const* t) const
   {
     return hash_value(*t);
   }
@@ -34,4 +39,15 @@ using Expr_hash = Term_hash<Expr>;
 using Cons_hash = Term_hash<Cons>;
 
 
+// Hash function for lists of terms (e.g., template arguments).
+// Each element is hashed according to its kind.
+struct Term_list_hash
+{
+  std::size_t operator()(Term_list const&) const;
+};
+
+
 } // namespace banjo
+
+
+#endif
@@ -2,19 +2,110 @@
 // All rights reserved
 
 #include "inheritance.hpp"
+#include "ast.hpp"
 
 
 namespace banjo
 {
 
-// Returns true if t1 is a base class of t2.
+// Returns the class declaration of the base class type `t`.
 //
-// TODO: Implement me.
+// FIXME: Diagnose non-class base types during semantic analysis.
+inline Class_decl&
+base_class_declaration(Type& t)
+{
+  return cast<Class_type>(t).declaration();
+}
+
+
+// Returns the linearized list of (direct and indirect) base classes
+// of `c`. Bases are listed in depth-first, left-to-right order, and
+// each class appears only once, even if it is inherited along several
+// paths.
+//
+// The result is cached together with the transitive closure of the
+// base class relation, which is represented as a bitset indexed by
+// class number. The cache is computed from the cached lists of the
+// direct bases, so this requires O(bases) time when first computed
+// and constant time thereafter.
+//
+// An incomplete class has no base classes. The cache is retained
+// only if `c` and all of its bases are complete, so that queries
+// made while a class is being defined are recomputed once the class
+// definition has been attached.
+std::vector<Class_decl*> const&
+base_classes(Class_decl& c)
+{
+  if (c.cached)
+    return c.bases;
+
+  c.bases.clear();
+  c.closure.clear();
+
+  if (!c.is_definition())
+    return c.bases;
+
+  bool complete = true;
+  for (Type& t : c.definition().bases()) {
+    Class_decl& b = base_class_declaration(t);
+    std::vector<Class_decl*> const& bs = base_classes(b);
+    complete &= b.cached;
+
+    // Grow the closure to accommodate the base and its bases.
+    std::size_t n = std::max(b.number() + 1, b.closure.size());
+    if (c.closure.size() < n)
+      c.closure.resize(n);
+
+    // Add b and its bases, in order, unless they have already been
+    // found through some other base.
+    if (!c.closure.test(b.number())) {
+      c.closure.set(b.number());
+      c.bases.push_back(&b);
+    }
+    for (Class_decl* d : bs) {
+      if (!c.closure.test(d->number())) {
+        c.closure.set(d->number());
+        c.bases.push_back(d);
+      }
+    }
+  }
+
+  c.cached = complete;
+  return c.bases;
+}
+
+
+// Returns true if `b` is a (direct or indirect) base class of `d`.
+// Note that a class is not a base class of itself.
+bool
+is_base_class(Class_decl const& b, Class_decl const& d)
+{
+  Class_decl& c = const_cast<Class_decl&>(d);
+  base_classes(c);
+  std::size_t n = b.number();
+  return n < c.closure.size() && c.closure.test(n);
+}
+
+
+// Returns true if t1 is a base class of t2. Cv-qualifiers are
+// ignored.
 bool
 is_base_class(Type const& t1, Type const& t2)
 {
+  Class_type const* b = as<Class_type>(&t1.unqualified_type());
+  Class_type const* d = as<Class_type>(&t2.unqualified_type());
+  if (b && d)
+    return is_base_class(b->declaration(), d->declaration());
   return false;
 }
 
 
+// Returns true if t1 is derived from t2.
+bool
+is_derived_class(Type const& t1, Type const& t2)
+{
+  return is_base_class(t2, t1);
+}
+
+
 } // namespace banjo
@@ -1,8 +1,8 @@
 // Copyright (c) 2015-2016 Andrew Sutton
 // All rights reserved
 
-#ifndef BANJO_CONVERT_HPP
-#define BANJO_CONVERT_HPP
+#ifndef BANJO_INHERITANCE_HPP
+#define BANJO_INHERITANCE_HPP
 
 #include "prelude.hpp"
 #include "context.hpp"
@@ -12,9 +12,14 @@ namespace banjo
 {
 
 struct Type;
+struct Class_decl;
 
 
+std::vector<Class_decl*> const& base_classes(Class_decl&);
+
+bool is_base_class(Class_decl const&, Class_decl const&);
 bool is_base_class(Type const&, Type const&);
+bool is_derived_class(Type const&, Type const&);
 
 } // namespace banjo
 
@@ -3,9 +3,13 @@
 
 #include "lookup.hpp"
 #include "scope.hpp"
+#include "inheritance.hpp"
 #include "print.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <unordered_set>
+#include <utility>
 
 
 namespace banjo
@@ -15,50 +19,120 @@ namespace banjo
 using Binding = Scope::Binding;
 
 
+// Returns the scope nominated by the nested-name-specifier of
+// the declaration `d`, or nullptr if `d` was not declared by a
+// qualified-id.
+inline Scope*
+qualifying_scope(Decl& d)
+{
+  if (Qualified_id* q = as<Qualified_id>(&d.name()))
+    return q->scope().scope();
+  return nullptr;
+}
+
+
+// Search for `id` in the base classes of `c`. A declaration in a
+// base class hides declarations of the same name in its own bases.
+// The name is ambiguous if, after removing the hidden declarations,
+// it is found in more than one base class.
+//
+// Note that each base class is searched at most once, even when it
+// is inherited along several paths.
+inline Overload_set*
+lookup_in_bases(Class_decl& c, Simple_id const& id)
+{
+  // Collect the base classes that declare the name.
+  std::vector<std::pair<Class_decl*, Overload_set*>> found;
+  for (Class_decl* b : base_classes(c)) {
+    if (Overload_set* ovl = b->scope()->lookup(id))
+      found.emplace_back(b, ovl);
+  }
+
+  // Discard those that are bases of another.
+  Overload_set* ovl = nullptr;
+  for (auto const& f1 : found) {
+    bool hidden = false;
+    for (auto const& f2 : found) {
+      if (is_base_class(*f1.first, *f2.first)) {
+        hidden = true;
+        break;
+      }
+    }
+    if (hidden)
+      continue;
+    if (ovl)
+      throw Lookup_error("lookup of '{}' is ambiguous", id);
+    ovl = f1.second;
+  }
+  return ovl;
+}
+
+
+// Search for the member `id` in the class `c` and its base classes.
+// Returns nullptr if no such member is found.
+inline Overload_set*
+lookup_member(Class_decl& c, Simple_id const& id)
+{
+  if (Overload_set* ovl = c.scope()->lookup(id))
+    return ovl;
+  return lookup_in_bases(c, id);
+}
+
+
 // Returns the non-empty set of declarations for give (unqualified) id.
-// Throws an exception if no matching declarations are found.
+// Throws an exception if no matching declarations are found. The result
+// refers to the overload set in the scope where the name was found.
 //
 // Lookup ends as soon as a declaration is found for the given name.
 //
 // TODO: How should we handle non-simple id's like operator-ids
 // and conversion function ids.
-Decl_list
+Overload_view
 unqualified_lookup(Scope& scope, Simple_id const& id)
 {
   Scope* p = &scope;
+  Scope* q = nullptr; // A qualifying scope, if any.
   while (p) {
+    // If we have left the definition of an entity declared by a
+    // qualified-id, search the scope(s) named by that id before
+    // resuming the search in the enclosing namespace or class.
+    // Stop if we reach the enclosing scope itself.
+    if (q && (is<Namespace_scope>(p) || is<Class_scope>(p))) {
+      for (; q && q != p; q = q->enclosing_scope()) {
+        if (Overload_set* ovl = q->lookup(id))
+          return *ovl;
+      }
+      q = nullptr;
+    }
+
     // In general, a name used in any context must be declared
     // before it's use. Search this scope for such a declaration.
     if (Overload_set* ovl = p->lookup(id))
-      return ovl->base();
+      return *ovl;
 
     // Depending on current scope, we might re-direct the scope
     // to search different things.
 
     if (Function_scope* s = as<Function_scope>(p)) {
-      Decl& f = s->declaration();
-      (void)f;
-
-      // TODO: If fn is defined by a qualified-id, then we should
-      // should search the scope(s) named in the id before resuming
-      // the search.
+      // If fn is defined by a qualified-id, then we search the
+      // scope(s) named in the id after the parameter scope.
+      q = qualifying_scope(s->declaration());
     }
 
     else if (Class_scope* cs = as<Class_scope>(p)) {
-      Class_decl& c = cs->declaration();
-      (void)c;
-
-      // TODO: Include base classes of c. Lookup also depends on
-      // the declarative region of c (nested classes, locals, etc).
+      // Search the base classes of c before moving outward.
+      //
+      // TODO: Lookup also depends on the declarative region of c
+      // (nested classes, locals, etc).
+      if (Overload_set* ovl = lookup_in_bases(cs->declaration(), id))
+        return *ovl;
     }
 
 
     else if (Initializer_scope* s = as<Initializer_scope>(p)) {
-      Decl& v = s->declaration();
-      (void)v;
-
-      // TODO: If v is declared by a qualified-id, then re-direct
-      // to the scope of v before working outwards.
+      // If v is declared by a qualified-id, then re-direct to the
+      // scope of v before working outwards.
+      q = qualifying_scope(s->declaration());
     }
 
     p = p->enclosing_scope();
@@ -73,7 +147,7 @@ unqualified_lookup(Scope& scope, Simple_id const& id)
 Decl&
 simple_lookup(Scope& scope, Simple_id const& id)
 {
-  Decl_list result = unqualified_lookup(scope, id);
+  Overload_view result = unqualified_lookup(scope, id);
 
   // FIXME: Can we find names that are *like* id?
   if (result.empty())
@@ -88,20 +162,216 @@ simple_lookup(Scope& scope, Simple_id const& id)
 }
 
 
-/*
-Decl_list
-qualified_lookup(Scope&, Symbol const&)
+// -------------------------------------------------------------------------- //
+// Qualified lookup
+
+// Returns the set of declarations of `id` in the scope `s`. Unlike
+// unqualified lookup, the search does not continue into enclosing
+// scopes. Each scope indexes its members by name, so this requires
+// a single hash table probe regardless of the size of the scope.
+//
+// TODO: Search inline namespaces and namespaces nominated by
+// using-directives when we support those.
+Overload_view
+qualified_lookup(Scope& s, Simple_id const& id)
 {
-  return nullptr;
+  if (Overload_set* ovl = s.lookup(id))
+    return *ovl;
+
+  if (Decl* d = s.context())
+    throw Lookup_error("no member named '{}' in '{}'", id, d->name());
+  throw Lookup_error("no matching declaration for '{}'", id);
+}
+
+
+// Returns the set of declarations of `id` in the declarative region
+// of `d`. This is lookup of a name following a nested-name-specifier
+// that denotes `d`.
+//
+// If `d` is a class, its base classes are also searched.
+Overload_view
+qualified_lookup(Decl& d, Simple_id const& id)
+{
+  if (Class_decl* c = as<Class_decl>(&d)) {
+    if (Overload_set* ovl = lookup_member(*c, id))
+      return *ovl;
+    throw Lookup_error("no member named '{}' in '{}'", id, d.name());
+  }
+  if (Scope* s = d.scope())
+    return qualified_lookup(*s, id);
+  throw Lookup_error("'{}' does not name a namespace or class", d.name());
+}
+
+
+// -------------------------------------------------------------------------- //
+// Argument-dependent lookup
+
+// Returns the innermost namespace enclosing `d`. A declaration that
+// has no context is a member of the global namespace.
+Namespace_decl&
+enclosing_namespace(Context& cxt, Decl& d)
+{
+  Decl* p = d.context();
+  while (p) {
+    if (Namespace_decl* ns = as<Namespace_decl>(p))
+      return *ns;
+    p = p->context();
+  }
+  return cxt.global_namespace();
+}
+
+
+// Returns the associated namespaces of the user-defined type declared
+// by `d`. For classes, this includes the namespaces of all base
+// classes.
+Namespace_list
+associated_namespaces(Context& cxt, Decl& d)
+{
+  Namespace_list ns {&enclosing_namespace(cxt, d)};
+  if (Class_decl* c = as<Class_decl>(&d)) {
+    for (Class_decl* b : base_classes(*c)) {
+      Namespace_decl* n = &enclosing_namespace(cxt, *b);
+      if (std::find(ns.begin(), ns.end(), n) == ns.end())
+        ns.push_back(n);
+    }
+  }
+  return ns;
+}
+
+
+// Returns true if the associated namespaces of `d` can be saved.
+// This is not the case for classes that are still being defined.
+inline bool
+has_stable_namespaces(Decl& d)
+{
+  if (Class_decl* c = as<Class_decl>(&d)) {
+    base_classes(*c);
+    return c->cached;
+  }
+  return true;
+}
+
+
+namespace
+{
+
+// Accumulates the associated namespaces of a sequence of types. Each
+// user-defined type and each namespace is considered at most once.
+struct Associated_namespaces
+{
+  Associated_namespaces(Context& c)
+    : cxt(c)
+  { }
+
+  void add_type(Type&);
+  void add_decl(Decl&);
+
+  Context&                        cxt;
+  Namespace_list                  ns;
+  std::unordered_set<Decl const*> seen;
+};
+
+
+// Add the associated namespaces of `t`. Fundamental types have
+// no associated namespaces.
+void
+Associated_namespaces::add_type(Type& t)
+{
+  struct fn
+  {
+    Associated_namespaces& self;
+    void operator()(Type&)                { }
+    void operator()(Function_type& t)
+    {
+      for (Type& p : t.parameter_types())
+        self.add_type(p);
+      self.add_type(t.return_type());
+    }
+    void operator()(Qualified_type& t)    { self.add_type(t.type()); }
+    void operator()(Pointer_type& t)      { self.add_type(t.type()); }
+    void operator()(Reference_type& t)    { self.add_type(t.type()); }
+    void operator()(Array_type& t)        { self.add_type(*t.first); }
+    void operator()(Sequence_type& t)     { self.add_type(t.type()); }
+    void operator()(User_defined_type& t) { self.add_decl(t.declaration()); }
+  };
+  apply(t, fn{*this});
 }
 
 
+// Add the associated namespaces of the type declared by `d`. The
+// namespaces of each type are computed once and saved in the context
+// so that argument-dependent lookup does not recompute them for every
+// call.
+void
+Associated_namespaces::add_decl(Decl& d)
+{
+  if (!seen.insert(&d).second)
+    return;
+
+  Lookup_state& st = cxt.lookup_state();
+  Namespace_list tmp;
+  Namespace_list const* list;
+  auto iter = st.assoc.find(&d);
+  if (iter != st.assoc.end()) {
+    list = &iter->second;
+  } else if (has_stable_namespaces(d)) {
+    list = &st.assoc.emplace(&d, associated_namespaces(cxt, d)).first->second;
+  } else {
+    tmp = associated_namespaces(cxt, d);
+    list = &tmp;
+  }
+
+  for (Namespace_decl* n : *list) {
+    if (seen.insert(n).second)
+      ns.push_back(n);
+  }
+}
+
+
+} // namespace
+
+
+// Returns the set of namespaces associated with the types of
+// the arguments `args`.
+Namespace_list
+associated_namespaces(Context& cxt, Expr_list& args)
+{
+  Associated_namespaces an(cxt);
+  for (Expr& e : args)
+    an.add_type(e.type());
+  return std::move(an.ns);
+}
+
+
+// Returns true if `d` is a function or function template.
+inline bool
+is_function_or_template(Decl& d)
+{
+  return is<Function_decl>(&d.parameterized_declaration());
+}
+
+
+// Perform argument-dependent lookup for the unqualified function
+// name `id` called with the arguments `args`. This returns the
+// functions and function templates declared in the namespaces
+// associated with the argument types. The result may be empty.
+//
+// Note that each namespace is searched at most once, and that the
+// associated namespaces of each type are cached.
 Decl_list
-argument_dependent_lookup(Scope&, Expr_list&)
+argument_dependent_lookup(Context& cxt, Simple_id const& id, Expr_list& args)
 {
-  return nullptr;
+  Decl_list result;
+  for (Namespace_decl* ns : associated_namespaces(cxt, args)) {
+    if (Overload_set* ovl = ns->scope()->lookup(id)) {
+      for (Decl* d : *ovl) {
+        if (is_function_or_template(*d))
+          result.push_back(d);
+      }
+    }
+  }
+  return result;
 }
-*/
 
 
 } // namespace banjo
@@ -7,9 +7,13 @@
 #include "prelude.hpp"
 #include "context.hpp"
 #include "ast.hpp"
+#include "overload.hpp"
 
 #include <lingo/environment.hpp>
 
+#include <unordered_map>
+#include <vector>
+
 
 namespace banjo
 {
@@ -18,11 +22,28 @@ namespace banjo
 struct Simple_id;
 
 
-Decl&     simple_lookup(Scope&, Simple_id const&);
-Decl_list unqualified_lookup(Scope&, Simple_id const&);
+using Namespace_list = std::vector<Namespace_decl*>;
+
+
+// The lookup state of a context. The associated namespaces of each
+// user-defined type are computed once.
+struct Lookup_state
+{
+  using Namespace_map = std::unordered_map<Decl const*, Namespace_list>;
+
+  Namespace_map assoc; // Associated namespaces of user-defined types
+};
+
+
+Decl&         simple_lookup(Scope&, Simple_id const&);
+Overload_view unqualified_lookup(Scope&, Simple_id const&);
+Overload_view qualified_lookup(Scope&, Simple_id const&);
+Overload_view qualified_lookup(Decl&, Simple_id const&);
+Decl_list     argument_dependent_lookup(Context&, Simple_id const&, Expr_list&);
 
-// Decl_list qualified_lookup(Scope&, Symbol const&);
-// Decl_list argument_dependent_lookup(Scope&, Expr_list&);
+Namespace_decl& enclosing_namespace(Context&, Decl&);
+Namespace_list  associated_namespaces(Context&, Decl&);
+Namespace_list  associated_namespaces(Context&, Expr_list&);
 
 
 } // namespace banjo
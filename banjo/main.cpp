@@ -4,11 +4,13 @@
 #include "context.hpp"
 #include "lexer.hpp"
 #include "parser.hpp"
+#include "subsumption.hpp"
 
 #include <lingo/file.hpp>
 #include <lingo/io.hpp>
 #include <lingo/error.hpp>
 
+#include <cstring>
 #include <iostream>
 
 
@@ -21,12 +23,15 @@ main(int argc, char* argv[])
 {
   Context cxt;
 
-  if (argc != 2) {
-    std::cerr << "usage: banjo-compile <input-file>\n";
+  // With --stats, print statistics about constraint checking
+  // after the input is processed.
+  bool stats = argc == 3 && std::strcmp(argv[1], "--stats") == 0;
+  if (argc != 2 && !stats) {
+    std::cerr << "usage: banjo-compile [--stats] <input-file>\n";
     return -1;
   }
 
-  File input(argv[1]);
+  File input(argv[argc - 1]);
   Character_stream cs(input);
   Token_stream ts(input);
   Lexer lex(cxt, cs, ts);
@@ -39,7 +44,9 @@ main(int argc, char* argv[])
 
   // Transform tokens into a syntax tree.
   Term& unit = parse();
-  
+  if (stats)
+    dump_subsumption_stats(std::cerr, cxt);
+
   // if (error_count())
   //   return 1;
   // (void)unit;
@@ -4,15 +4,153 @@
 #include "normalization.hpp"
 #include "ast.hpp"
 #include "builder.hpp"
+#include "constraint.hpp"
 #include "print.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 
 namespace banjo
 {
 
-// TODO: Apply obious simplifications at this point?
+// -------------------------------------------------------------------------- //
+// Simplification
+//
+// Conjunctions and disjunctions are simplified as they are built. The
+// operands of nested conjunctions (or disjunctions) are collected into
+// a single list from which
+//
+// - true and false are folded: A /\ true is A and A /\ false is false,
+// - duplicates are removed: A /\ A is A, and
+// - absorbed operands are removed: A /\ (A \/ B) is A.
+//
+// The remaining operands are sorted into a canonical order and rebuilt
+// as a right-nested chain of binary constraints. Constraints are unique,
+// so equivalent operands have the same address. Operands are ordered by
+// when they were first seen, so A /\ B and B /\ A are the same constraint.
+
+using Cons_seq = std::vector<Cons*>;
+
+
+// Returns true if `c` is the predicate constraint `v`.
+inline bool
+is_constant(Cons const& c, bool v)
+{
+  if (Predicate_cons const* p = as<Predicate_cons>(&c))
+    if (Boolean_expr const* b = as<Boolean_expr>(&p->expression()))
+      return b->value() == v;
+  return false;
+}
+
+
+// Append the operands of `c` to `ops`. Operands of nested constraints
+// of kind T are appended recursively.
+template<typename T>
+void
+collect_operands(Cons& c, Cons_seq& ops)
+{
+  if (T* k = as<T>(&c)) {
+    collect_operands<T>(k->left(), ops);
+    collect_operands<T>(k->right(), ops);
+  } else {
+    ops.push_back(&c);
+  }
+}
+
+
+// Returns true if any operand of `c`, a constraint of kind T, is
+// in `ops`.
+template<typename T>
+bool
+has_operand(Cons const& c, Cons_seq const& ops)
+{
+  if (T const* k = as<T>(&c))
+    return has_operand<T>(k->left(), ops) || has_operand<T>(k->right(), ops);
+  return std::find(ops.begin(), ops.end(), &c) != ops.end();
+}
+
+
+// Sort the operands into canonical order.
+void
+sort_operands(Context& cxt, Cons_seq& ops)
+{
+  Constraint_state& st = cxt.constraint_state();
+  for (Cons* c : ops)
+    st.order.emplace(c, st.order.size());
+  std::sort(ops.begin(), ops.end(), [&st](Cons* a, Cons* b) {
+    return st.order[a] < st.order[b];
+  });
+}
+
+
+// Simplify the constraint combining `l` and `r` with the operator
+// whose constraints are of kind T. The dual operator has constraints
+// of kind U. The identity of the operator is `unit`, and its negation
+// is the zero of the operator. The function `make` builds a binary
+// constraint from its operands.
+template<typename T, typename U, typename F>
+Cons&
+simplify(Context& cxt, Cons& l, Cons& r, bool unit, F make)
+{
+  Builder build(cxt);
+  Cons_seq ops;
+  collect_operands<T>(l, ops);
+  collect_operands<T>(r, ops);
+
+  // Fold constants.
+  auto zero = [unit](Cons* c) { return is_constant(*c, !unit); };
+  auto one = [unit](Cons* c) { return is_constant(*c, unit); };
+  if (std::any_of(ops.begin(), ops.end(), zero))
+    return build.get_predicate_constraint(build.get_bool(!unit));
+  ops.erase(std::remove_if(ops.begin(), ops.end(), one), ops.end());
+  if (ops.empty())
+    return build.get_predicate_constraint(build.get_bool(unit));
+
+  // Remove duplicates.
+  sort_operands(cxt, ops);
+  ops.erase(std::unique(ops.begin(), ops.end()), ops.end());
+
+  // Remove absorbed operands.
+  Cons_seq res;
+  for (Cons* c : ops)
+    if (!is<U>(c) || !has_operand<U>(*c, ops))
+      res.push_back(c);
+
+  Cons* c = res.back();
+  for (auto iter = res.rbegin() + 1; iter != res.rend(); ++iter)
+    c = &make(**iter, *c);
+  return *c;
+}
+
+
+// Returns the simplified conjunction of `l` and `r`.
+Cons&
+simplify_conjunction(Context& cxt, Cons& l, Cons& r)
+{
+  Builder build(cxt);
+  auto make = [&build](Cons& a, Cons& b) -> Cons& {
+    return build.get_conjunction_constraint(a, b);
+  };
+  return simplify<Conjunction_cons, Disjunction_cons>(cxt, l, r, true, make);
+}
+
+
+// Returns the simplified disjunction of `l` and `r`.
+Cons&
+simplify_disjunction(Context& cxt, Cons& l, Cons& r)
+{
+  Builder build(cxt);
+  auto make = [&build](Cons& a, Cons& b) -> Cons& {
+    return build.get_disjunction_constraint(a, b);
+  };
+  return simplify<Disjunction_cons, Conjunction_cons>(cxt, l, r, false, make);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Normalization
 
 Predicate_cons&
 normalize_expr(Context& cxt, Expr& e)
@@ -22,23 +160,21 @@ normalize_expr(Context& cxt, Expr& e)
 }
 
 
-Conjunction_cons&
+Cons&
 normalize_and(Context& cxt, And_expr& e)
 {
-  Builder build(cxt);
   Cons& l = normalize(cxt, e.left());
   Cons& r = normalize(cxt, e.right());
-  return build.get_conjunction_constraint(l, r);
+  return simplify_conjunction(cxt, l, r);
 }
 
 
-Disjunction_cons&
+Cons&
 normalize_or(Context& cxt, Or_expr& e)
 {
-  Builder build(cxt);
   Cons& l = normalize(cxt, e.left());
   Cons& r = normalize(cxt, e.right());
-  return build.get_disjunction_constraint(l, r);
+  return simplify_disjunction(cxt, l, r);
 }
 
 
@@ -16,6 +16,8 @@ struct Context;
 
 
 Cons& normalize(Context&, Expr&);
+Cons& simplify_conjunction(Context&, Cons&, Cons&);
+Cons& simplify_disjunction(Context&, Cons&, Cons&);
 
 
 } // namespace banjo
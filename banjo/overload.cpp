@@ -3,6 +3,7 @@
 
 #include "overload.hpp"
 #include "ast.hpp"
+#include "equivalence.hpp"
 
 
 namespace banjo
@@ -23,14 +24,129 @@ Overload_set::name()
 }
 
 
+// Returns the category of the type `t`. References and
+// cv-qualifiers are ignored.
+Type_category
+get_type_category(Type const& t)
+{
+  struct fn
+  {
+    Type_category operator()(Type const&)           { return unknown_cat; }
+    Type_category operator()(Boolean_type const&)   { return arithmetic_cat; }
+    Type_category operator()(Integer_type const&)   { return arithmetic_cat; }
+    Type_category operator()(Float_type const&)     { return arithmetic_cat; }
+    Type_category operator()(Pointer_type const&)   { return pointer_cat; }
+    Type_category operator()(Class_type const&)     { return class_cat; }
+    Type_category operator()(Union_type const&)     { return class_cat; }
+    Type_category operator()(Enum_type const&)      { return enum_cat; }
+  };
+  Type const* u = &t;
+  if (Reference_type const* r = as<Reference_type>(u))
+    u = &r->type();
+  return apply(u->unqualified_type(), fn{});
+}
+
+
+// Returns true if an argument in category `a` could be converted
+// to a parameter in category `p`. Dependent and unclassified types
+// are compatible with all categories.
+bool
+is_compatible_category(Type_category p, Type_category a)
+{
+  return p == unknown_cat || a == unknown_cat || p == a;
+}
+
+
+// Returns the function type of `d` or nullptr if `d` does not
+// declare a function or function template.
+inline Function_type*
+get_function_type(Decl& d)
+{
+  if (Function_decl* f = as<Function_decl>(&d.parameterized_declaration()))
+    return &f->type();
+  return nullptr;
+}
+
+
+// Add the declaration `d` to the candidate index.
+inline void
+index_declaration(Overload_set& ovl, Decl& d)
+{
+  if (Function_type* t = get_function_type(d)) {
+    Type_list& ps = t->parameter_types();
+    Type_category c = ps.empty() ? unknown_cat : get_type_category(ps.front());
+    ovl.arity[ps.size()][c].push_back(&d);
+  } else {
+    ovl.nonfunc.push_back(&d);
+  }
+}
+
+
+// Index any declarations added since the last update. Previous
+// resolutions are no longer valid if any declarations were added.
+void
+Overload_set::update()
+{
+  if (indexed == size())
+    return;
+  for (; indexed < size(); ++indexed)
+    index_declaration(*this, *(*this)[indexed]);
+  resolved.clear();
+}
+
+
+// Returns the list of declarations in the overload set that could
+// accept the given arguments. For functions, only those with the
+// same number of parameters as there are arguments and whose first
+// parameter type is compatible with the first argument are selected.
+// Declarations that are not functions are always selected.
+//
+// This does not build any conversions; candidates must still be
+// checked for viability.
+//
+// TODO: Account for default arguments and variadic parameters
+// when we support them.
+std::vector<Decl*>
+Overload_set::candidates(Expr_list const& args)
+{
+  update();
+
+  std::vector<Decl*> result = nonfunc;
+  auto iter = arity.find(args.size());
+  if (iter == arity.end())
+    return result;
+
+  Bucket& b = iter->second;
+  if (args.empty()) {
+    result.insert(result.end(), b[unknown_cat].begin(), b[unknown_cat].end());
+    return result;
+  }
+
+  Type_category a = get_type_category(args.front().type());
+  for (int c = 0; c < type_category_count; ++c) {
+    if (is_compatible_category(Type_category(c), a))
+      result.insert(result.end(), b[c].begin(), b[c].end());
+  }
+  return result;
+}
+
+
 // Returns true if a new declaration `d1` can be declared as
-// an overload of an existing declartion `d2`.
+// an overload of an existing declartion `d2`. Functions and
+// function templates can be overloaded when their types differ.
 //
-// TODO: Implement me.
+// TODO: Consider constraints. Function templates with the same
+// type and different constraints can also be overloaded.
 bool
 can_overload(Decl& d1, Decl& d2)
 {
-  return false;
+  Function_type* t1 = get_function_type(d1);
+  Function_type* t2 = get_function_type(d2);
+  if (!t1 || !t2)
+    return false;
+  if (is<Template_decl>(&d1) != is<Template_decl>(&d2))
+    return true;
+  return !is_equivalent(*t1, *t2);
 }
 
 
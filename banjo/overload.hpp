@@ -5,6 +5,12 @@
 #define BANJO_OVERLOAD_HPP
 
 #include "prelude.hpp"
+#include "ast_base.hpp"
+#include "hash.hpp"
+#include "equivalence.hpp"
+
+#include <algorithm>
+#include <unordered_map>
 
 
 namespace banjo
@@ -14,13 +20,78 @@ struct Name;
 struct Decl;
 
 
-// Represents a set of overloaded declarations. All declarations have 
-// the same name, scope, and kind, but may differ in their different 
+// Categories of types used to quickly reject candidates during
+// overload resolution. An argument can only be converted to a
+// parameter type in the same category.
+//
+// TODO: Revisit these categories when we support user-defined
+// conversions and derived-to-base conversions.
+enum Type_category
+{
+  unknown_cat,    // Dependent and unclassified types
+  arithmetic_cat, // Boolean, integer, and floating point types
+  pointer_cat,    // Pointer types
+  class_cat,      // Class and union types
+  enum_cat,       // Enumeration types
+  type_category_count
+};
+
+
+Type_category get_type_category(Type const&);
+bool          is_compatible_category(Type_category, Type_category);
+
+
+// A sequence of types, hashed and compared by their structure.
+using Type_seq = std::vector<Type const*>;
+
+
+struct Type_seq_hash
+{
+  std::size_t operator()(Type_seq const& ts) const
+  {
+    std::size_t h = 0;
+    for (Type const* t : ts)
+      boost::hash_combine(h, hash_value(*t));
+    return h;
+  }
+};
+
+
+struct Type_seq_eq
+{
+  bool operator()(Type_seq const& a, Type_seq const& b) const
+  {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+      [](Type const* t1, Type const* t2) { return is_equivalent(*t1, *t2); });
+  }
+};
+
+
+// Maps the types of call arguments to the function selected by
+// overload resolution.
+using Resolution_map = std::unordered_map<
+  Type_seq, Decl*, Type_seq_hash, Type_seq_eq
+>;
+
+
+// Represents a set of overloaded declarations. All declarations have
+// the same name, scope, and kind, but may differ in their different
 // types and constraints.
 //
 // Note that an overload set is never empty.
+//
+// The overload set maintains an index of its function declarations,
+// keyed by the number of parameters and the category of the first
+// parameter type. The index is updated lazily when candidates are
+// requested, so declarations can be appended directly. The set also
+// records the results of overload resolution for the argument types
+// of previous calls. These are discarded when declarations are added.
 struct Overload_set : std::vector<Decl*>
 {
+  // Functions with a given number of parameters, grouped by the
+  // category of the first parameter type.
+  using Bucket = std::vector<Decl*>[type_category_count];
+
   using std::vector<Decl*>::vector;
 
   // Returns the underlying list of declarations.
@@ -30,6 +101,56 @@ struct Overload_set : std::vector<Decl*>
   // Returns the name of the overloaded declaratin.
   Name const& name() const;
   Name&       name();
+
+  // Returns the declarations that could accept the arguments.
+  std::vector<Decl*> candidates(Expr_list const&);
+
+  // Update the index with declarations added to the set.
+  void update();
+
+  std::unordered_map<std::size_t, Bucket> arity;     // Functions by arity
+  std::vector<Decl*>                      nonfunc;   // Other declarations
+  std::size_t                             indexed = 0;
+  Resolution_map                          resolved;  // Previous resolutions
+};
+
+
+// A non-owning view of an overload set. Name lookup returns views
+// so that finding a name does not copy (or allocate) the set of
+// declarations found. Use list() to obtain a copy that can be
+// modified.
+//
+// Note that the view refers to the overload set stored in a scope.
+// Later declarations of the same name in that scope are visible
+// through the view.
+struct Overload_view
+{
+  using iterator = List_iterator<Decl>;
+
+  Overload_view(Overload_set& s)
+    : ovl(&s)
+  { }
+
+  // Returns the number of declarations in the set.
+  std::size_t size() const { return ovl->size(); }
+
+  // Returns true if the set is empty. Note that this is never
+  // the case for sets found by lookup.
+  bool empty() const { return ovl->empty(); }
+
+  // Returns the first declaration in the set.
+  Decl& front() const { return *ovl->front(); }
+
+  iterator begin() const { return ovl->begin(); }
+  iterator end() const   { return ovl->end(); }
+
+  // Returns the underlying overload set.
+  Overload_set& set() const { return *ovl; }
+
+  // Returns a list containing the declarations in the set.
+  Decl_list list() const { return Decl_list(ovl->base()); }
+
+  Overload_set* ovl;
 };
 
 
@@ -294,7 +294,7 @@ Parser::class_declaration()
   Decl& cls = on_class_declaration(tok, n);
 
   if (!match_if(semicolon_tok)) {
-    // FIXME: Enter class scpoe.
+    Enter_scope scope(cxt, cast<Class_decl>(cls.parameterized_declaration()));
     class_definition(cls);
   }
 
@@ -310,8 +310,6 @@ Parser::class_declaration()
 //
 //    class-body:
 //      '{' [member-seq] '}'
-//
-// TODO: Implment base class parsing.
 Def&
 Parser::class_definition(Decl& d)
 {
@@ -322,13 +320,44 @@ Parser::class_definition(Decl& d)
     return on_deleted_definition(d);
   }
 
+  // Match the base clause.
+  Type_list bs;
+  if (lookahead() == colon_tok)
+    bs = base_clause();
+
   // Match the class body.
   Decl_list ds;
   match(lbrace_tok);
   if (lookahead() != rbrace_tok)
     ds = member_seq();
   match(rbrace_tok);
-  return on_class_definition(d, ds);
+  return on_class_definition(d, bs, ds);
+}
+
+
+// Parse a base-clause.
+//
+//    base-clause:
+//      ':' base-specifier-list
+//
+//    base-specifier-list:
+//      base-specifier
+//      base-specifier-list ',' base-specifier
+//
+//    base-specifier:
+//      class-name
+//
+// TODO: Support access specifiers and virtual base classes.
+Type_list
+Parser::base_clause()
+{
+  match(colon_tok);
+  Type_list bs;
+  do {
+    Type& t = class_name();
+    bs.push_back(t);
+  } while (match_if(comma_tok));
+  return bs;
 }
 
 
@@ -152,11 +152,23 @@ Parser::unary_expression()
 //      postfix-expression '(' [expression-list] ')'
 //      postfix-expression '[' [expression-list] ']'
 //
+// A name that is called may denote an overload set. The name is
+// resolved together with the arguments of the call.
+//
 // TODO: Add lots of stuff here.
 Expr&
 Parser::postfix_expression()
 {
-  Expr* e = &primary_expression();
+  Expr* e;
+  if (lookahead() == identifier_tok) {
+    Name& n = id();
+    if (lookahead() == lparen_tok)
+      e = &call_expression(n);
+    else
+      e = &on_id_expression(n);
+  } else {
+    e = &primary_expression();
+  }
   while (true) {
     if (lookahead() == lparen_tok)
       e = &call_expression(*e);
@@ -184,6 +196,19 @@ Parser::call_expression(Expr& e)
 }
 
 
+// Parse a call to the function (or functions) named by `n`.
+Expr&
+Parser::call_expression(Name& n)
+{
+  Expr_list es;
+  require(lparen_tok);
+  if (lookahead() != rparen_tok)
+    es = expression_list();
+  match(rparen_tok);
+  return on_call_expression(n, es);
+}
+
+
 // Parse a comma-separated list of expressions.
 //
 //    expression-list;
@@ -84,6 +84,7 @@ struct Parser
   Expr& unary_expression();
   Expr& postfix_expression();
   Expr& call_expression(Expr&);
+  Expr& call_expression(Name&);
   Expr& subscript_expression(Expr&);
   Expr& primary_expression();
   Expr& id_expression();
@@ -125,6 +126,7 @@ struct Parser
   // Classes
   Decl& class_declaration();
   Def& class_definition(Decl&);
+  Type_list base_clause();
   Decl_list member_seq();
   Decl& member_declaration();
 
@@ -218,6 +220,7 @@ struct Parser
   Expr& on_le_expression(Token, Expr&, Expr&);
   Expr& on_ge_expression(Token, Expr&, Expr&);
   Expr& on_call_expression(Expr&, Expr_list&);
+  Expr& on_call_expression(Name&, Expr_list&);
   Expr& on_id_expression(Name&);
   Expr& on_boolean_literal(Token, bool);
   Expr& on_integer_literal(Token);
@@ -247,7 +250,7 @@ struct Parser
   Expr& on_brace_initialization(Decl&, Expr_list&);
   // Definitions
   Def& on_function_definition(Decl&, Stmt&);
-  Def& on_class_definition(Decl&, Decl_list&);
+  Def& on_class_definition(Decl&, Type_list&, Decl_list&);
   Def& on_concept_definition(Decl&, Expr&);
   Def& on_concept_definition(Decl&, Req_list&);
   Def& on_deleted_definition(Decl&);
@@ -957,6 +957,19 @@ Printer::class_definition(Def const& d)
 void
 Printer::class_definition(Class_def const& d)
 {
+  if (!d.bases().empty()) {
+    space();
+    token(colon_tok);
+    space();
+    for (auto iter = d.bases().begin(); iter != d.bases().end(); ++iter) {
+      type(*iter);
+      if (std::next(iter) != d.bases().end()) {
+        token(comma_tok);
+        space();
+      }
+    }
+  }
+
   if (d.members().empty()) {
     space();
     token(lbrace_tok);
@@ -8,18 +8,413 @@
 #include "builder.hpp"
 #include "print.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 
 namespace banjo
 {
 
+// -------------------------------------------------------------------------- //
+// Memoization
+//
+// The satisfaction of concept checks and predicates is memoized.
+// Constraints are unique, so the result for a concept check is
+// keyed on the concept and its (canonical) arguments.
+//
+// A check whose arguments name an incomplete class may be satisfied
+// differently once that class is defined. The same is true of a
+// predicate whose expression names an incomplete class, and of any
+// check whose expansion contains such a check or predicate. Each
+// active check or predicate records the incomplete declarations it
+// names. When its result is known, those declarations, and those of
+// the constraints in its expansion, are added to each enclosing check.
+// This is also done for results found in the memo.
+
+
+// Add the incomplete declaration named by `t`, if any, to `ds`. A
+// compound type depends on the declaration of its element type.
+void
+find_incomplete(Type const& t, Satisfaction_state::Decl_set& ds)
+{
+  if (Qualified_type const* q = as<Qualified_type>(&t))
+    return find_incomplete(q->type(), ds);
+  if (Pointer_type const* p = as<Pointer_type>(&t))
+    return find_incomplete(p->type(), ds);
+  if (Reference_type const* r = as<Reference_type>(&t))
+    return find_incomplete(r->type(), ds);
+  if (Array_type const* a = as<Array_type>(&t))
+    return find_incomplete(a->type(), ds);
+  if (Sequence_type const* s = as<Sequence_type>(&t))
+    return find_incomplete(s->type(), ds);
+  if (Function_type const* f = as<Function_type>(&t)) {
+    for (Type const& p : f->parameter_types())
+      find_incomplete(p, ds);
+    return find_incomplete(f->return_type(), ds);
+  }
+  if (User_defined_type const* u = as<User_defined_type>(&t)) {
+    if (Type_decl const* d = as<Type_decl>(&u->declaration()))
+      if (!d->is_defined())
+        ds.push_back(d);
+  }
+}
+
+
+// Add the incomplete declarations named by the arguments `ts` to `ds`.
+void
+find_incomplete(Term_list const& ts, Satisfaction_state::Decl_set& ds)
+{
+  for (Term const& t : ts)
+    if (Type const* u = as<Type>(&t))
+      find_incomplete(*u, ds);
+}
+
+
+// Add the incomplete declarations named by the type of `e`, or of any
+// of its operands, to `ds`.
+void
+find_incomplete(Expr const& e, Satisfaction_state::Decl_set& ds)
+{
+  struct fn
+  {
+    Satisfaction_state::Decl_set& ds;
+    void operator()(Expr const& e)        { }
+    void operator()(Unary_expr const& e)  { find_incomplete(e.operand(), ds); }
+    void operator()(Check_expr const& e)  { find_incomplete(e.arguments(), ds); }
+    void operator()(Conv const& e)        { find_incomplete(e.source(), ds); }
+    void operator()(Copy_init const& e)   { find_incomplete(e.expression(), ds); }
+    void operator()(Bind_init const& e)   { find_incomplete(e.expression(), ds); }
+
+    void operator()(Binary_expr const& e)
+    {
+      find_incomplete(e.left(), ds);
+      find_incomplete(e.right(), ds);
+    }
+
+    void operator()(Call_expr const& e)
+    {
+      find_incomplete(e.function(), ds);
+      for (Expr const& a : e.arguments())
+        find_incomplete(a, ds);
+    }
+  };
+  find_incomplete(e.type(), ds);
+  apply(e, fn{ds});
+}
+
+
+// Add the incomplete declarations `ds` to each active check.
+inline void
+add_incomplete(Satisfaction_state& st, Satisfaction_state::Decl_set const& ds)
+{
+  for (Satisfaction_state::Decl_set& f : st.frames)
+    for (Decl const* d : ds)
+      if (std::find(f.begin(), f.end(), d) == f.end())
+        f.push_back(d);
+}
+
+
+// An RAII helper that records the incomplete declarations named by
+// the arguments of a concept check, or by the expression of a
+// predicate, while it is being satisfied. On exit, they are added
+// to each enclosing check.
+struct Enter_check
+{
+  Enter_check(Context& cxt, Concept_cons const& c)
+    : st(cxt.satisfaction_state())
+  {
+    st.frames.emplace_back();
+    find_incomplete(c.arguments(), st.frames.back());
+  }
+
+  Enter_check(Context& cxt, Predicate_cons const& p)
+    : st(cxt.satisfaction_state())
+  {
+    st.frames.emplace_back();
+    find_incomplete(p.expression(), st.frames.back());
+  }
+
+  ~Enter_check()
+  {
+    Satisfaction_state::Decl_set ds = std::move(st.frames.back());
+    st.frames.pop_back();
+    if (!ds.empty())
+      add_incomplete(st, ds);
+  }
+
+  Satisfaction_state& st;
+};
+
+
+// Returns the memoized result for `c`, if any. The incomplete
+// declarations of the result are added to each active check.
+inline bool const*
+lookup_satisfaction(Context& cxt, Cons const& c)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  auto iter = st.memo.find(&c);
+  if (iter == st.memo.end()) {
+    ++st.misses;
+    return nullptr;
+  }
+  ++st.hits;
+  auto deps = st.incomplete.find(&c);
+  if (deps != st.incomplete.end())
+    add_incomplete(st, deps->second);
+  return &iter->second;
+}
+
+
+// Memoize the result for `c`, listing it with each incomplete
+// declaration recorded by its check. Returns the result.
+inline bool
+memoize_satisfaction(Context& cxt, Cons const& c, bool r)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  st.memo.emplace(&c, r);
+  Satisfaction_state::Decl_set& ds = st.frames.back();
+  if (!ds.empty()) {
+    std::sort(ds.begin(), ds.end());
+    ds.erase(std::unique(ds.begin(), ds.end()), ds.end());
+    for (Decl const* d : ds)
+      st.deps[d].push_back(&c);
+    st.incomplete.emplace(&c, ds);
+  }
+  return r;
+}
+
+
+// Returns statistics about memoized satisfaction results.
+Satisfaction_stats
+get_satisfaction_stats(Context const& cxt)
+{
+  Satisfaction_state const& st = cxt.satisfaction_state();
+  return {st.memo.size(), st.hits, st.misses};
+}
+
+
+// Discard the memoized results that depend on the declaration `d`.
+// This must be called when an incomplete declaration is completed.
+void
+invalidate_satisfaction(Context& cxt, Decl const& d)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  auto iter = st.deps.find(&d);
+  if (iter == st.deps.end())
+    return;
+  for (Cons const* c : iter->second) {
+    st.memo.erase(c);
+    st.incomplete.erase(c);
+  }
+  st.deps.erase(iter);
+}
+
+
+// Discard all memoized satisfaction results.
+void
+clear_satisfaction_memo(Context& cxt)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  st.memo.clear();
+  st.deps.clear();
+  st.incomplete.clear();
+  st.hits = 0;
+  st.misses = 0;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Planning
+//
+// Constraints have no side effects, so the operands of a conjunction
+// (or disjunction) can be satisfied in any order. The operands of nested
+// conjunctions are collected and ordered so that those most likely to
+// decide the result cheaply are satisfied first. Each operand is ranked
+// by its estimated cost divided by the probability that it decides the
+// result: that it fails, for a conjunction, or holds, for a disjunction.
+//
+// - A constraint whose satisfaction is memoized costs nothing.
+// - A predicate costs one evaluation, and fails as often as the other
+//   instances of the atom it was substituted from.
+// - A concept check costs, on average, what checks of that concept have
+//   cost before, and fails as often. Without a history, the cost is
+//   estimated from the normalized definition of the concept.
+//
+// Estimates for nested constraints combine those of their operands.
+
+
+// The estimated cost of satisfying a constraint, and the probability
+// that it is not satisfied.
+struct Estimate
+{
+  double cost;
+  double fail;
+};
+
+
+Estimate estimate(Context&, Cons&);
+
+
+// Returns the probability that a constraint fails, given its history.
+inline double
+failure_rate(Satisfaction_profile const& p)
+{
+  return (p.fails + 1.0) / (p.evals + 2.0);
+}
+
+
+// Returns the atom from which `p` was substituted, or `p` itself.
+inline Cons const&
+get_origin(Context& cxt, Predicate_cons const& p)
+{
+  Constraint_state& st = cxt.constraint_state();
+  auto iter = st.origins.find(&p);
+  if (iter != st.origins.end())
+    return *iter->second;
+  return p;
+}
+
+
+inline Estimate
+estimate_predicate(Context& cxt, Predicate_cons& p)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  auto iter = st.atoms.find(&get_origin(cxt, p));
+  if (iter == st.atoms.end())
+    return {1.0, 0.5};
+  return {1.0, failure_rate(iter->second)};
+}
+
+
+inline Estimate
+estimate_concept(Context& cxt, Concept_cons& c)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  Concept_decl& d = c.declaration();
+  auto iter = st.profiles.find(&d);
+  if (iter == st.profiles.end()) {
+    Constraint_props const& p = get_concept_properties(cxt, d);
+    return {1.0 + p.atoms + p.checks, 0.5};
+  }
+  Satisfaction_profile const& p = iter->second;
+  return {double(p.cost) / p.evals, failure_rate(p)};
+}
+
+
+inline Estimate
+estimate_conjunction(Context& cxt, Conjunction_cons& c)
+{
+  Estimate l = estimate(cxt, c.left());
+  Estimate r = estimate(cxt, c.right());
+  return {l.cost + r.cost, 1.0 - (1.0 - l.fail) * (1.0 - r.fail)};
+}
+
+
+inline Estimate
+estimate_disjunction(Context& cxt, Disjunction_cons& c)
+{
+  Estimate l = estimate(cxt, c.left());
+  Estimate r = estimate(cxt, c.right());
+  return {l.cost + r.cost, l.fail * r.fail};
+}
+
+
+// Estimate the cost of satisfying `c`.
+Estimate
+estimate(Context& cxt, Cons& c)
+{
+  Satisfaction_state& st = cxt.satisfaction_state();
+  auto iter = st.memo.find(&c);
+  if (iter != st.memo.end())
+    return {0.0, iter->second ? 0.0 : 1.0};
+
+  struct fn
+  {
+    Context& cxt;
+    Estimate operator()(Cons& c)             { return {1.0, 0.5}; }
+    Estimate operator()(Predicate_cons& c)   { return estimate_predicate(cxt, c); }
+    Estimate operator()(Concept_cons& c)     { return estimate_concept(cxt, c); }
+    Estimate operator()(Conjunction_cons& c) { return estimate_conjunction(cxt, c); }
+    Estimate operator()(Disjunction_cons& c) { return estimate_disjunction(cxt, c); }
+  };
+  return apply(c, fn{cxt});
+}
+
+
+using Plan = std::vector<Cons*>;
+
+
+// Append the operands of `c` to `p`. Operands of nested constraints
+// of kind T are appended recursively.
+template<typename T>
+void
+add_to_plan(Cons& c, Plan& p)
+{
+  if (T* k = as<T>(&c)) {
+    add_to_plan<T>(k->left(), p);
+    add_to_plan<T>(k->right(), p);
+  } else {
+    p.push_back(&c);
+  }
+}
+
+
+// Returns the operands of `c`, a constraint of kind T, in the order
+// they should be satisfied. The result of the constraint is decided
+// by an operand whose result is `v`.
+template<typename T>
+Plan
+make_plan(Context& cxt, T& c, bool v)
+{
+  Plan ops;
+  add_to_plan<T>(c, ops);
+
+  std::vector<std::pair<double, Cons*>> ranks;
+  for (Cons* op : ops) {
+    Estimate e = estimate(cxt, *op);
+    double p = v ? 1.0 - e.fail : e.fail;
+    ranks.emplace_back(e.cost / std::max(p, 1e-6), op);
+  }
+  auto cmp = [](std::pair<double, Cons*> const& a,
+                std::pair<double, Cons*> const& b) {
+    return a.first < b.first;
+  };
+  std::stable_sort(ranks.begin(), ranks.end(), cmp);
+
+  for (std::size_t i = 0; i < ops.size(); ++i)
+    ops[i] = ranks[i].second;
+  return ops;
+}
+
+
+// Record the result and cost of satisfying a constraint in `p`.
+inline void
+record_profile(Satisfaction_profile& p, bool r, std::size_t n)
+{
+  ++p.evals;
+  if (!r)
+    ++p.fails;
+  p.cost += n;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Satisfaction
+
 // To satisfy a concept check, we must instantiate that
 // concept with the given arguments.
 inline bool
 satisfy_concept(Context& cxt, Concept_cons& c)
 {
-  return is_satisfied(cxt, expand(cxt, c));
+  Satisfaction_state& st = cxt.satisfaction_state();
+  if (bool const* r = lookup_satisfaction(cxt, c))
+    return *r;
+  Enter_check check(cxt, c);
+  std::size_t n = st.misses;
+  bool r = is_satisfied(cxt, expand(cxt, c));
+  record_profile(st.profiles[&c.declaration()], r, st.misses - n);
+  return memoize_satisfaction(cxt, c, r);
 }
 
 
@@ -28,29 +423,39 @@ satisfy_concept(Context& cxt, Concept_cons& c)
 inline bool
 satisfy_predicate(Context& cxt, Predicate_cons& p)
 {
-  Value v = evaluate(p.expression());
-  return v.get_boolean();
+  Satisfaction_state& st = cxt.satisfaction_state();
+  if (bool const* r = lookup_satisfaction(cxt, p))
+    return *r;
+  Enter_check check(cxt, p);
+  bool r = evaluate(p.expression()).get_boolean();
+  record_profile(st.atoms[&get_origin(cxt, p)], r, 1);
+  return memoize_satisfaction(cxt, p, r);
 }
 
 
-// A conjunction is satisfied iff both operands are satisfied.
-// The right operand is not evaluated if the left operand is
-// not satisfied.
+// A conjunction is satisfied iff all of its operands are satisfied.
+// Operands are satisfied in planned order, and no operand is satisfied
+// after one is not.
 inline bool
 satisfy_conjunction(Context& cxt, Conjunction_cons& c)
 {
-  return is_satisfied(cxt, c.left())
-      && is_satisfied(cxt, c.right());
+  for (Cons* op : make_plan(cxt, c, false))
+    if (!is_satisfied(cxt, *op))
+      return false;
+  return true;
 }
 
 
-// A disjunction is satsifed iff either operand is satisfied. The
-// right operand is not evaluated if the left operand is satisfied.
+// A disjunction is satsifed iff any of its operands are satisfied.
+// Operands are satisfied in planned order, and no operand is satisfied
+// after one is.
 inline bool
 satisfy_disjunction(Context& cxt, Disjunction_cons& c)
 {
-  return is_satisfied(cxt, c.left())
-      || is_satisfied(cxt, c.right());
+  for (Cons* op : make_plan(cxt, c, true))
+    if (is_satisfied(cxt, *op))
+      return true;
+  return false;
 }
 
 
@@ -8,13 +8,76 @@
 #include "context.hpp"
 #include "substitution.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 namespace banjo
 {
 
+// The history of satisfying checks of a concept, or instances of an
+// atomic constraint: the number satisfied, the number that failed, and
+// the total number of constraints evaluated to satisfy them.
+struct Satisfaction_profile
+{
+  std::size_t evals;
+  std::size_t fails;
+  std::size_t cost;
+};
+
+
+// The satisfaction state of a context. The satisfaction of each
+// (unique) concept check and predicate is memoized. Results that
+// depend on incomplete declarations are listed for each such
+// declaration, and discarded when that declaration is completed.
+//
+// Each active check accumulates the incomplete declarations that its
+// result depends on: those it names, and those of every check and
+// predicate satisfied in its expansion.
+struct Satisfaction_state
+{
+  using Memo_map = std::unordered_map<Cons const*, bool>;
+  using Decl_set = std::vector<Decl const*>;
+  using Dependency_map =
+    std::unordered_map<Decl const*, std::vector<Cons const*>>;
+  using Incomplete_map = std::unordered_map<Cons const*, Decl_set>;
+  using Frame_stack = std::vector<Decl_set>;
+  using Profile_map =
+    std::unordered_map<Decl const*, Satisfaction_profile>;
+  using Atom_map = std::unordered_map<Cons const*, Satisfaction_profile>;
+
+  Satisfaction_state()
+    : hits(0), misses(0)
+  { }
+
+  Memo_map       memo;       // Memoized satisfaction results
+  Dependency_map deps;       // Results for each incomplete declaration
+  Incomplete_map incomplete; // Incomplete declarations of each result
+  Frame_stack    frames;     // Incomplete declarations of active checks
+  std::size_t    hits;       // Constraints found in the memo
+  std::size_t    misses;     // Constraints evaluated
+  Profile_map    profiles;   // Satisfaction history of each concept
+  Atom_map       atoms;      // Satisfaction history of each atom
+};
+
+
 bool is_satisfied(Context&, Cons&);
 bool is_satisfied(Context&, Expr&);
 
 
+// Statistics for the memoization of satisfaction.
+struct Satisfaction_stats
+{
+  std::size_t size;   // The number of memoized results
+  std::size_t hits;   // Constraints answered by the memo
+  std::size_t misses; // Constraints evaluated
+};
+
+
+Satisfaction_stats get_satisfaction_stats(Context const&);
+void               invalidate_satisfaction(Context&, Decl const&);
+void               clear_satisfaction_memo(Context&);
+
+
 } // namespace banjo
 
 
@@ -27,6 +27,16 @@ Scope::bind(Decl& d)
 }
 
 
+// Compute the depth of the template parameter scope.
+Template_parameter_scope::Template_parameter_scope(Scope& s)
+  : Scope(s), dep(0), count(0)
+{
+  for (Scope* p = &s; p; p = p->enclosing_scope())
+    if (is<Template_parameter_scope>(p))
+      ++dep;
+}
+
+
 Namespace_decl const&
 Namespace_scope::declaration() const
 {
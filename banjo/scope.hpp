@@ -168,19 +168,27 @@ struct Function_parameter_scope : Scope
 };
 
 
-// Represents the scope of template parameter names.
+// Represents the scope of template parameter names. Parameters
+// declared in this scope are indexed by the depth of the scope
+// and their order of declaration.
 struct Template_parameter_scope : Scope
 {
-  Template_parameter_scope(Scope& s)
-    : Scope(s)
-  { }
+  Template_parameter_scope(Scope& s);
+
+  // Returns the number of enclosing template parameter scopes.
+  int depth() const { return dep; }
+
+  int dep;   // The depth of the parameter list
+  int count; // The number of declared parameters
 };
 
 
 // Represents a class scope.
 struct Class_scope : Scope
 {
-  // Returns the function declaration associated with the scope.
+  using Scope::Scope;
+
+  // Returns the class declaration associated with the scope.
   Class_decl const& declaration() const;
   Class_decl&       declaration();
 };
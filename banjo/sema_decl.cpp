@@ -5,6 +5,9 @@
 #include "ast_decl.hpp"
 #include "ast_def.hpp"
 #include "declaration.hpp"
+#include "template.hpp"
+#include "constraint.hpp"
+#include "satisfaction.hpp"
 #include "print.hpp"
 
 #include <iostream>
@@ -158,13 +161,25 @@ Parser::on_class_declaration(Token tok, Name& n)
 }
 
 
+// Each base class must be complete.
+//
 // FIXME: Analyze the class body and nominate special
 // constructors, identify class properties, etc.
 Def&
-Parser::on_class_definition(Decl& d, Decl_list& ds)
+Parser::on_class_definition(Decl& d, Type_list& bs, Decl_list& ds)
 {
-  Def& def = build.make_class_definition(ds);
-  return define_entity(d, def);
+  for (Type& b : bs) {
+    Class_decl& c = cast<Class_type>(b).declaration();
+    if (!c.is_definition())
+      throw Type_error("base class '{}' is incomplete", b);
+  }
+
+  Def& def = build.make_class_definition(bs, ds);
+  define_entity(d, def);
+
+  // Checks naming the class may be satisfied differently now.
+  invalidate_satisfaction(cxt, d.parameterized_declaration());
+  return def;
 }
 
 
@@ -203,11 +218,13 @@ Parser::on_type_template_parameter(Name& n, Type& t)
 // -------------------------------------------------------------------------- //
 // Concepts
 
+// Define the concept and normalize its definition.
 static inline void
-define_concept(Decl& decl, Def& def)
+define_concept(Context& cxt, Decl& decl, Def& def)
 {
   Concept_decl& con = cast<Concept_decl>(decl);
   con.def = &def;
+  normalize_definition(cxt, con);
 }
 
 
@@ -224,7 +241,7 @@ Def&
 Parser::on_concept_definition(Decl& decl, Expr& e)
 {
   Def& def = build.make_expression_definition(e);
-  define_concept(decl, def);
+  define_concept(cxt, decl, def);
   return def;
 }
 
@@ -234,7 +251,7 @@ Parser::on_concept_definition(Decl& decl, Req_list& ds)
 {
   lingo_unimplemented();
   // Def& def = build.make_concept_definition(ds);
-  // define_concept(decl, def);
+  // define_concept(cxt, decl, def);
   // return def;
 }
 
@@ -249,6 +266,9 @@ Parser::on_translation_unit(Decl_list& ds)
 {
   Namespace_decl& ns = cxt.global_namespace();
   ns.decls.append(ds.begin(), ds.end());
+
+  // Instantiate the definitions of used specializations.
+  instantiate_pending(cxt);
   return ns;
 }
 
@@ -5,6 +5,7 @@
 #include "ast_expr.hpp"
 #include "ast_type.hpp"
 #include "ast_decl.hpp"
+#include "call.hpp"
 #include "expression.hpp"
 #include "print.hpp"
 
@@ -83,25 +84,19 @@ Parser::on_ge_expression(Token tok, Expr& e1, Expr& e2)
 }
 
 
-// TODO: This is going to be non-trivial.
 Expr&
 Parser::on_call_expression(Expr& e, Expr_list& es)
 {
-  if (Reference_expr* ref = as<Reference_expr>(&e)) {
-    Decl& d = ref->declaration();
-    Type& t = declared_type(d);
-    if (Function_type* f = as<Function_type>(&t))
-      return build.make_call(f->return_type(), e, es);
-
-    // FIXME: Handle lambda expressions. Handle objects of class
-    // type with overloads of '()'.
-
-    throw Translation_error("'{}' is not callable", e);
-  }
+  return build_function_call(cxt, e, es);
+}
 
-  // FIXME: Handle overload sets.
 
-  lingo_unimplemented();
+// Unqualified function names also find the functions declared in the
+// namespaces associated with the arguments.
+Expr&
+Parser::on_call_expression(Name& n, Expr_list& es)
+{
+  return build_function_call(cxt, n, es);
 }
 
 
@@ -128,16 +128,27 @@ Parser::on_nested_name_specifier(Decl&, Name&)
 // name.
 
 Type&
-Parser::on_class_name(Token)
+Parser::on_class_name(Token tok)
 {
-  throw Lookup_error("not a class");
+  Simple_id& id = build.get_id(tok);
+  Decl& decl = simple_lookup(current_scope(), id);
+  if (Class_decl* d = as<Class_decl>(&decl))
+    return build.get_class_type(*d);
+  throw Lookup_error("'{}' does not name a class", id);
 }
 
 
+// Check if the template-id n refers to a class.
 Type&
-Parser::on_class_name(Name&)
+Parser::on_class_name(Name& n)
 {
-  throw Lookup_error("not a class");
+  Template_id& id = cast<Template_id>(n);
+  Template_decl& tmp = id.declaration();
+  Term_list& args = id.arguments();
+  Decl& decl = specialize_template(cxt, tmp, args);
+  if (Class_decl* d = as<Class_decl>(&decl))
+    return build.get_class_type(*d);
+  throw Lookup_error("not a class name");
 }
 
 
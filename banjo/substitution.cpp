@@ -2,9 +2,13 @@
 // All rights reserved
 
 #include "substitution.hpp"
+#include "template.hpp"
+#include "constraint.hpp"
 #include "builder.hpp"
+#include "normalization.hpp"
 #include "print.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -21,6 +25,8 @@ operator<<(std::ostream& os, Substitution const& s)
 {
   os << "{\n";
   for (auto& x : s) {
+    if (!x.first)
+      continue;
     os << "  " << *x.first << " => ";
     if (x.second)
       os << *x.second;
@@ -33,6 +39,207 @@ operator<<(std::ostream& os, Substitution const& s)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Memoization
+
+std::size_t
+Substitution_hash::operator()(Substitution_key const& k) const
+{
+  std::size_t h = 0;
+  boost::hash_combine(h, k.depth);
+  for (Term const& t : k.args) {
+    if (Type const* x = as<Type>(&t))
+      boost::hash_combine(h, hash_value(*x));
+    else
+      boost::hash_combine(h, &t);
+  }
+  return h;
+}
+
+
+bool
+Substitution_eq::operator()(Substitution_key const& a,
+                            Substitution_key const& b) const
+{
+  auto cmp = [](Term const& x, Term const& y) {
+    if (Type const* t = as<Type>(&x))
+      return is<Type>(&y) && is_equivalent(*t, cast<Type>(y));
+    return &x == &y;
+  };
+  return a.depth == b.depth
+      && std::equal(a.args.begin(), a.args.end(),
+                    b.args.begin(), b.args.end(), cmp);
+}
+
+
+// Returns the memo for the substitution `sub`. The memo is found
+// using the canonical form of the substitution: its depth and its
+// arguments, ordered by parameter offset. Returns nullptr if some
+// parameter is not mapped, or if the substitution rebinds
+// declarations.
+Substitution_memo*
+get_memo(Context& cxt, Substitution& sub)
+{
+  if (!sub.binds.empty())
+    return nullptr;
+  if (sub.memo)
+    return sub.memo;
+
+  Substitution_key key {sub.depth(), {}};
+  key.args.reserve(sub.maps.size());
+  for (auto& x : sub) {
+    if (!x.second)
+      return nullptr;
+    key.args.push_back(x.second);
+  }
+  sub.memo = &cxt.substitution_state().memos[key];
+  return sub.memo;
+}
+
+
+// Returns the memoized result of substituting into `t`, or computes
+// it using `f`.
+template<typename T, typename F>
+T&
+memoize(Context& cxt, T& t, Substitution& sub, F f)
+{
+  Substitution_memo* memo = get_memo(cxt, sub);
+  if (!memo)
+    return f();
+  auto iter = memo->find(&t);
+  if (iter != memo->end())
+    return cast<T>(*iter->second);
+  T& r = f();
+  memo->emplace(&t, &r);
+  return r;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Dependence
+
+
+bool
+is_dependent(Term const& x)
+{
+  if (Type const* t = as<Type>(&x))
+    return is_dependent(*t);
+  if (Expr const* e = as<Expr>(&x))
+    return is_dependent(*e);
+  if (Decl const* d = as<Decl>(&x))
+    return is<Type_parm>(d) || is<Value_parm>(d) || is<Template_parm>(d);
+  lingo_unreachable();
+}
+
+
+template<typename T>
+inline bool
+is_dependent(List<T> const& list)
+{
+  for (T const& x : list)
+    if (is_dependent(x))
+      return true;
+  return false;
+}
+
+
+// Compute the dependence of a type. Fundamental and user-defined
+// types are not dependent. Other types that are not handled by
+// substitution (e.g., auto and array types) are conservatively
+// considered dependent.
+inline bool
+compute_dependence(Type const& t)
+{
+  struct fn
+  {
+    bool operator()(Type const& t)           { return false; }
+    bool operator()(Auto_type const& t)      { return true; }
+    bool operator()(Decltype_type const& t)  { return true; }
+    bool operator()(Declauto_type const& t)  { return true; }
+    bool operator()(Array_type const& t)     { return true; }
+    bool operator()(Typename_type const& t)  { return true; }
+    bool operator()(Reference_type const& t) { return is_dependent(t.type()); }
+    bool operator()(Qualified_type const& t) { return is_dependent(t.type()); }
+    bool operator()(Pointer_type const& t)   { return is_dependent(t.type()); }
+    bool operator()(Sequence_type const& t)  { return is_dependent(t.type()); }
+
+    bool operator()(Function_type const& t)
+    {
+      return is_dependent(t.parameter_types())
+          || is_dependent(t.return_type());
+    }
+  };
+  return apply(t, fn{});
+}
+
+
+bool
+is_dependent(Type const& t)
+{
+  if (t.dep == unknown_dep)
+    t.dep = compute_dependence(t) ? dependent_dep : nondependent_dep;
+  return t.dep == dependent_dep;
+}
+
+
+// Returns true if `d` is a specialization whose template arguments
+// are dependent.
+inline bool
+is_dependent_specialization(Decl const& d)
+{
+  if (Template_id const* id = as<Template_id>(&d.name()))
+    return is_dependent(id->arguments());
+  return false;
+}
+
+
+// Compute the dependence of an expression. Expressions that are
+// not handled by substitution are conservatively considered
+// dependent.
+inline bool
+compute_dependence(Expr const& e)
+{
+  struct fn
+  {
+    bool operator()(Expr const& e)           { return true; }
+    bool operator()(Boolean_expr const& e)   { return false; }
+    bool operator()(Integer_expr const& e)   { return false; }
+    bool operator()(Synthetic_expr const& e) { return false; }
+    bool operator()(Check_expr const& e)     { return is_dependent(e.arguments()); }
+    bool operator()(Unary_expr const& e)     { return is_dependent(e.operand()); }
+    bool operator()(Copy_init const& e)      { return is_dependent(e.type()) || is_dependent(e.expression()); }
+    bool operator()(Bind_init const& e)      { return is_dependent(e.type()) || is_dependent(e.expression()); }
+
+    bool operator()(Reference_expr const& e)
+    {
+      return is_dependent(e.declaration())
+          || is_dependent_specialization(e.declaration())
+          || is_dependent(e.type());
+    }
+
+    bool operator()(Binary_expr const& e)
+    {
+      return is_dependent(e.left()) || is_dependent(e.right());
+    }
+
+    bool operator()(Call_expr const& e)
+    {
+      return is_dependent(e.function()) || is_dependent(e.arguments());
+    }
+  };
+  return apply(e, fn{});
+}
+
+
+bool
+is_dependent(Expr const& e)
+{
+  if (e.dep == unknown_dep)
+    e.dep = compute_dependence(e) ? dependent_dep : nondependent_dep;
+  return e.dep == dependent_dep;
+}
+
+
 // -------------------------------------------------------------------------- //
 // Substitution helpers
 
@@ -101,7 +308,13 @@ substitute(Context& cxt, Type& t, Substitution& sub)
     Type& operator()(Sequence_type& t)  { return substitute_type(cxt, t, sub); }
     Type& operator()(Typename_type& t)  { return substitute_type(cxt, t, sub); }
   };
-  return apply(t, fn{cxt, sub});
+
+  // Non-dependent types are unchanged by substitution.
+  if (!is_dependent(t))
+    return t;
+  return memoize(cxt, t, sub, [&]() -> Type& {
+    return apply(t, fn{cxt, sub});
+  });
 }
 
 
@@ -179,12 +392,85 @@ substitute_type(Context& cxt, Typename_type& t, Substitution& sub)
 // result of substitution.
 
 
-// FIXME: This isn't right... we probably need to re-bind references,
-// especially when they refer to parameters or local variables.
+// Returns true if `e` refers to a declaration rebound by `sub`.
+bool
+refers_to_binding(Expr const& e, Substitution const& sub)
+{
+  struct fn
+  {
+    Substitution const& sub;
+    bool operator()(Expr const& e)           { return false; }
+    bool operator()(Reference_expr const& e) { return sub.get_binding(e.declaration()); }
+    bool operator()(Unary_expr const& e)     { return refers_to_binding(e.operand(), sub); }
+    bool operator()(Copy_init const& e)      { return refers_to_binding(e.expression(), sub); }
+    bool operator()(Bind_init const& e)      { return refers_to_binding(e.expression(), sub); }
+
+    bool operator()(Binary_expr const& e)
+    {
+      return refers_to_binding(e.left(), sub)
+          || refers_to_binding(e.right(), sub);
+    }
+
+    bool operator()(Call_expr const& e)
+    {
+      if (refers_to_binding(e.function(), sub))
+        return true;
+      for (Expr const& a : e.arguments())
+        if (refers_to_binding(a, sub))
+          return true;
+      return false;
+    }
+  };
+  if (sub.binds.empty())
+    return false;
+  return apply(e, fn{sub});
+}
+
+
+// References to a specialization with dependent arguments refer to
+// the specialization for the substituted arguments, whose definition
+// is requested.
+Expr&
+subst_specialization_ref(Context& cxt, Template_id& id, Substitution& sub)
+{
+  Builder build(cxt);
+  Term_list args = substitute(cxt, id.arguments(), sub);
+  Decl& d = specialize_template(cxt, id.declaration(), args);
+  request_instantiation(cxt, d);
+  if (Function_decl* f = as<Function_decl>(&d))
+    return build.make_reference(*f);
+  if (Variable_decl* v = as<Variable_decl>(&d))
+    return build.make_reference(*v);
+  banjo_unhandled_case(d);
+}
+
+
+// References to value parameters are replaced by their arguments.
+// References to rebound parameters and local variables refer to
+// the corresponding declarations of the instantiation.
 Expr&
 subst_ref(Context& cxt, Reference_expr& e, Substitution& sub)
 {
-  return e;
+  if (Template_id* id = as<Template_id>(&e.declaration().name())) {
+    if (is_dependent(id->arguments()))
+      return subst_specialization_ref(cxt, *id, sub);
+  }
+
+  Decl& p = e.declaration();
+  if (is<Value_parm>(&p) && sub.has_mapping(p)) {
+    if (Expr* a = as<Expr>(sub.get_mapping(p)))
+      return *a;
+  }
+
+  Decl* d = sub.get_binding(e.declaration());
+  if (!d)
+    return e;
+  Builder build(cxt);
+  if (Variable_decl* v = as<Variable_decl>(d))
+    return build.make_reference(*v);
+  if (Object_parm* p = as<Object_parm>(d))
+    return build.make_reference(*p);
+  banjo_unhandled_case(*d);
 }
 
 
@@ -236,6 +522,26 @@ subst_expr(Context& cxt, Not_expr& e, Substitution& sub)
 }
 
 
+Expr&
+subst_init(Context& cxt, Copy_init& e, Substitution& sub)
+{
+  Builder build(cxt);
+  Type& t = substitute(cxt, e.type(), sub);
+  Expr& x = substitute(cxt, e.expression(), sub);
+  return build.make_copy_init(t, x);
+}
+
+
+Expr&
+subst_init(Context& cxt, Bind_init& e, Substitution& sub)
+{
+  Builder build(cxt);
+  Type& t = substitute(cxt, e.type(), sub);
+  Expr& x = substitute(cxt, e.expression(), sub);
+  return build.make_bind_init(t, x);
+}
+
+
 Expr&
 substitute(Context& cxt, Expr& e, Substitution& sub)
 {
@@ -260,8 +566,18 @@ substitute(Context& cxt, Expr& e, Substitution& sub)
     Expr& operator()(Or_expr& e)  { return subst_expr(cxt, e, sub); }
     Expr& operator()(Not_expr& e) { return subst_expr(cxt, e, sub); }
 
+    Expr& operator()(Copy_init& e) { return subst_init(cxt, e, sub); }
+    Expr& operator()(Bind_init& e) { return subst_init(cxt, e, sub); }
+
   };
-  return apply(e, fn{cxt, sub});
+
+  // Non-dependent expressions are unchanged by substitution unless
+  // they refer to rebound declarations.
+  if (!is_dependent(e) && !refers_to_binding(e, sub))
+    return e;
+  return memoize(cxt, e, sub, [&]() -> Expr& {
+    return apply(e, fn{cxt, sub});
+  });
 }
 
 
@@ -287,6 +603,10 @@ substitute_decl(Context& cxt, Variable_decl& d, Substitution& sub)
   Type& t = substitute(cxt, d.type(), sub);
 
   Builder build(cxt);
+  if (d.has_initializer()) {
+    Expr& i = substitute(cxt, d.initializer(), sub);
+    return build.make_variable(n, t, i);
+  }
   return build.make_variable(n, t);
 }
 
@@ -323,6 +643,52 @@ substitute(Context& cxt, Decl& d, Substitution& sub)
 
 // -------------------------------------------------------------------------- //
 // Substitution into constraints
+//
+// Constraints are rebuilt through the unique factories, so that
+// substitution yields the canonical constraint for its arguments.
+
+Cons&
+subst_cons(Context& cxt, Concept_cons& c, Substitution& sub)
+{
+  Builder build(cxt);
+  Term_list args = substitute(cxt, c.arguments(), sub);
+  return build.get_concept_constraint(c.declaration(), args);
+}
+
+
+// The pattern of the resulting atom is recorded, so that the history
+// of satisfying its instances can be shared.
+Cons&
+subst_cons(Context& cxt, Predicate_cons& c, Substitution& sub)
+{
+  Builder build(cxt);
+  Expr& e = substitute(cxt, c.expression(), sub);
+  Predicate_cons& r = build.get_predicate_constraint(e);
+  if (&r != &c) {
+    Constraint_state& st = cxt.constraint_state();
+    auto iter = st.origins.find(&c);
+    st.origins.emplace(&r, iter != st.origins.end() ? iter->second : &c);
+  }
+  return r;
+}
+
+
+Cons&
+subst_cons(Context& cxt, Conjunction_cons& c, Substitution& sub)
+{
+  Cons& c1 = substitute(cxt, c.left(), sub);
+  Cons& c2 = substitute(cxt, c.right(), sub);
+  return simplify_conjunction(cxt, c1, c2);
+}
+
+
+Cons&
+subst_cons(Context& cxt, Disjunction_cons& c, Substitution& sub)
+{
+  Cons& c1 = substitute(cxt, c.left(), sub);
+  Cons& c2 = substitute(cxt, c.right(), sub);
+  return simplify_disjunction(cxt, c1, c2);
+}
 
 
 Cons&
@@ -332,9 +698,114 @@ substitute(Context& cxt, Cons& c, Substitution& sub)
   {
     Context&      cxt;
     Substitution& sub;
-    Cons& operator()(Cons& c)           { banjo_unhandled_case(c); }
+    Cons& operator()(Cons& c)             { banjo_unhandled_case(c); }
+    Cons& operator()(Concept_cons& c)     { return subst_cons(cxt, c, sub); }
+    Cons& operator()(Predicate_cons& c)   { return subst_cons(cxt, c, sub); }
+    Cons& operator()(Conjunction_cons& c) { return subst_cons(cxt, c, sub); }
+    Cons& operator()(Disjunction_cons& c) { return subst_cons(cxt, c, sub); }
   };
   return apply(c, fn{cxt, sub});
 }
 
+
+// -------------------------------------------------------------------------- //
+// Substitution into statements
+
+Stmt&
+subst_stmt(Context& cxt, Compound_stmt& s, Substitution& sub)
+{
+  Builder build(cxt);
+  Stmt_list ss = substitute(cxt, s.statements(), sub);
+  return build.make_compound_statement(ss);
+}
+
+
+Stmt&
+subst_stmt(Context& cxt, Expression_stmt& s, Substitution& sub)
+{
+  Builder build(cxt);
+  Expr& e = substitute(cxt, s.expression(), sub);
+  return build.make_expression_statement(e);
+}
+
+
+// Subsequent references to the declared entity refer to the
+// substituted declaration.
+Stmt&
+subst_stmt(Context& cxt, Declaration_stmt& s, Substitution& sub)
+{
+  Builder build(cxt);
+  Decl& d = substitute(cxt, s.declaration(), sub);
+  sub.bind(s.declaration(), d);
+  return build.make_declaration_statement(d);
+}
+
+
+Stmt&
+subst_stmt(Context& cxt, Return_stmt& s, Substitution& sub)
+{
+  Builder build(cxt);
+  Expr& e = substitute(cxt, s.expression(), sub);
+  return build.make_return_statement(e);
+}
+
+
+Stmt&
+substitute(Context& cxt, Stmt& s, Substitution& sub)
+{
+  struct fn
+  {
+    Context&      cxt;
+    Substitution& sub;
+    Stmt& operator()(Stmt& s)             { banjo_unhandled_case(s); }
+    Stmt& operator()(Compound_stmt& s)    { return subst_stmt(cxt, s, sub); }
+    Stmt& operator()(Expression_stmt& s)  { return subst_stmt(cxt, s, sub); }
+    Stmt& operator()(Declaration_stmt& s) { return subst_stmt(cxt, s, sub); }
+    Stmt& operator()(Return_stmt& s)      { return subst_stmt(cxt, s, sub); }
+  };
+  return apply(s, fn{cxt, sub});
+}
+
+
+// -------------------------------------------------------------------------- //
+// Substitution into definitions
+
+
+Def&
+subst_def(Context& cxt, Expression_def& d, Substitution& sub)
+{
+  Builder build(cxt);
+  Expr& e = substitute(cxt, d.expression(), sub);
+  return build.make_expression_definition(e);
+}
+
+
+Def&
+subst_def(Context& cxt, Function_def& d, Substitution& sub)
+{
+  Builder build(cxt);
+  Stmt& s = substitute(cxt, d.statement(), sub);
+  return build.make_function_definition(s);
+}
+
+
+// Note that deleted and defaulted definitions are unchanged by
+// substitution.
+Def&
+substitute(Context& cxt, Def& d, Substitution& sub)
+{
+  struct fn
+  {
+    Context&      cxt;
+    Substitution& sub;
+    Def& operator()(Def& d)            { banjo_unhandled_case(d); }
+    Def& operator()(Deleted_def& d)    { return d; }
+    Def& operator()(Defaulted_def& d)  { return d; }
+    Def& operator()(Expression_def& d) { return subst_def(cxt, d, sub); }
+    Def& operator()(Function_def& d)   { return subst_def(cxt, d, sub); }
+  };
+  return apply(d, fn{cxt, sub});
+}
+
+
 } // namespace banjo
@@ -8,10 +8,55 @@
 #include "context.hpp"
 #include "ast.hpp"
 
+#include <unordered_map>
+
 
 namespace banjo
 {
 
+// -------------------------------------------------------------------------- //
+// Substitution state
+
+// The canonical form of a substitution: the depth of its parameters
+// and the arguments for each parameter, in order.
+struct Substitution_key
+{
+  int       depth;
+  Term_list args;
+};
+
+
+// Hash and equality for substitution keys. Type arguments are
+// compared structurally, and all other terms by identity. See
+// substitution.cpp.
+struct Substitution_hash
+{
+  std::size_t operator()(Substitution_key const&) const;
+};
+
+
+struct Substitution_eq
+{
+  bool operator()(Substitution_key const&, Substitution_key const&) const;
+};
+
+
+// The results of a substitution, for each term.
+using Substitution_memo = std::unordered_map<Term const*, Term*>;
+
+
+// The substitution state of a context. Results are memoized for each
+// distinct substitution, and within that, for each term.
+struct Substitution_state
+{
+  using Memo_map = std::unordered_map<
+    Substitution_key, Substitution_memo, Substitution_hash, Substitution_eq
+  >;
+
+  Memo_map memos; // Memoized substitutions
+};
+
+
 // -------------------------------------------------------------------------- //
 // Substitution
 
@@ -21,10 +66,28 @@ namespace banjo
 // This mapping is general. We assume that the kind and type of
 // arguments match their corresponding declarations.
 //
-// Note that declarations are guaranteed to be unique, so we can
-// hash on identity rather than syntax.
-struct Substitution : std::unordered_map<Decl*, Term*>
+// Template parameters are identified by their index (depth, offset),
+// and a substitution maps the parameters at a single depth. The
+// mapping is stored as an array indexed by parameter offset. Each
+// entry records the mapped parameter (null if the offset is not in
+// the mapping) and its argument (null if not yet deduced).
+//
+// The results of substitution are memoized in the context. The
+// memo for this substitution is cached after its first use and
+// discarded whenever the mapping changes.
+//
+// When instantiating a definition, the substitution also binds the
+// parameters and local variables of the pattern to their substituted
+// declarations, so that references to them can be rebound. Results
+// depend on those bindings, so they are not memoized.
+struct Substitution
 {
+  using Mapping      = std::pair<Decl*, Term*>;
+  using Mapping_list = std::vector<Mapping>;
+  using Binding_map  = std::unordered_map<Decl const*, Decl*>;
+  using iterator       = Mapping_list::iterator;
+  using const_iterator = Mapping_list::const_iterator;
+
   Substitution();
   Substitution(Decl_list&);
   Substitution(Decl_list&, Term_list&);
@@ -40,20 +103,42 @@ struct Substitution : std::unordered_map<Decl*, Term*>
   // Returns true if there is a mapping for this parameter.
   bool has_mapping(Decl&) const;
 
+  // Bind the declaration `d` of the pattern to its substituted
+  // declaration `s`.
+  void bind(Decl& d, Decl& s);
+
+  // Returns the declaration bound to `d`, or nullptr if `d` is
+  // not bound.
+  Decl* get_binding(Decl const& d) const;
+
+  // Returns the depth of the mapped parameters.
+  int depth() const { return dep; }
+
+  // Iterators over the mappings, ordered by parameter offset. Note
+  // that unmapped offsets have a null parameter.
+  iterator       begin()       { return maps.begin(); }
+  iterator       end()         { return maps.end(); }
+  const_iterator begin() const { return maps.begin(); }
+  const_iterator end() const   { return maps.end(); }
+
   // Contextually convert to true whe the substitution is valid.
   explicit operator bool() const { return ok; }
 
   // Invalidate the substitution.
   void fail() { ok = false; }
 
-  bool ok; // Used to invalidate a substitution.
+  Mapping_list       maps;  // Mappings, indexed by offset
+  int                dep;   // The depth of mapped parameters
+  bool               ok;    // Used to invalidate a substitution.
+  Substitution_memo* memo;  // Memoized results
+  Binding_map        binds; // Rebound declarations
 };
 
 
 // Initialize an empty substitution.
 inline
 Substitution::Substitution()
-  : ok(true)
+  : dep(-1), ok(true), memo(nullptr)
 { }
 
 
@@ -62,9 +147,18 @@ Substitution::Substitution()
 // pointer.
 inline
 Substitution::Substitution(Decl_list& p)
+  : maps(p.size()), dep(-1), ok(true), memo(nullptr)
 {
-  for (Decl& d : p)
-    insert({&d, nullptr});
+  for (Decl& d : p) {
+    Index ix = parameter_index(d);
+    lingo_assert(dep == -1 || dep == ix.depth());
+    dep = ix.depth();
+
+    std::size_t n = ix.offset();
+    if (maps.size() <= n)
+      maps.resize(n + 1);
+    maps[n].first = &d;
+  }
 }
 
 
@@ -72,8 +166,9 @@ Substitution::Substitution(Decl_list& p)
 // `pi` in `p` to its corresponding `ai` in `a`.
 inline
 Substitution::Substitution(Decl_list& p, Term_list& a)
-  : ok(true)
+  : dep(-1), ok(true), memo(nullptr)
 {
+  maps.reserve(p.size());
   auto pi = p.begin();
   auto ai = a.begin();
   while (pi != p.end()) {
@@ -92,40 +187,73 @@ Substitution::Substitution(Decl_list& p, Term_list& a)
 inline void
 Substitution::map_to(Decl& d, Term& t)
 {
-  auto iter = find(&d);
-  if (iter == end()) {
-    emplace(&d, &t);
-  } else {
-    lingo_assert(!iter->second);
-    iter->second = &t;
-  }
+  Index ix = parameter_index(d);
+  lingo_assert(dep == -1 || dep == ix.depth());
+  dep = ix.depth();
+
+  std::size_t n = ix.offset();
+  if (maps.size() <= n)
+    maps.resize(n + 1);
+  Mapping& m = maps[n];
+  lingo_assert(!m.second);
+  m.first = &d;
+  m.second = &t;
+  memo = nullptr;
 }
 
 
 inline bool
 Substitution::has_mapping(Decl& d) const
 {
-  return count(&d) != 0;
+  Index ix = parameter_index(d);
+  std::size_t n = ix.offset();
+  return ix.depth() == dep && n < maps.size() && maps[n].first;
+}
+
+
+inline void
+Substitution::bind(Decl& d, Decl& s)
+{
+  binds[&d] = &s;
+  memo = nullptr;
+}
+
+
+inline Decl*
+Substitution::get_binding(Decl const& d) const
+{
+  auto iter = binds.find(&d);
+  return iter == binds.end() ? nullptr : iter->second;
 }
 
 
 inline Term const*
 Substitution::get_mapping(Decl& d) const
 {
-  return find(&d)->second;
+  return maps[parameter_index(d).offset()].second;
 }
 
 
 inline Term*
 Substitution::get_mapping(Decl& d)
 {
-  return find(&d)->second;
+  return maps[parameter_index(d).offset()].second;
 }
 
 
 std::ostream& operator<<(std::ostream&, Substitution const&);
 
 
+// -------------------------------------------------------------------------- //
+// Dependence
+
+// A type or expression is dependent when it mentions a template
+// parameter. Substitution does not change non-dependent terms.
+bool is_dependent(Term const&);
+bool is_dependent(Type const&);
+bool is_dependent(Expr const&);
+
+
 // -------------------------------------------------------------------------- //
 // Operations
 
@@ -134,6 +262,8 @@ Type& substitute(Context&, Type&, Substitution&);
 Expr& substitute(Context&, Expr&, Substitution&);
 Decl& substitute(Context&, Decl&, Substitution&);
 Cons& substitute(Context&, Cons&, Substitution&);
+Stmt& substitute(Context&, Stmt&, Substitution&);
+Def&  substitute(Context&, Def&, Substitution&);
 
 
 } // namespace banjo
@@ -10,155 +10,298 @@
 #include "equivalence.hpp"
 #include "print.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <tuple>
 #include <list>
+#include <memory>
+#include <sstream>
 #include <unordered_set>
-#include <iostream>
 
 
 namespace banjo
 {
 
 
+// -------------------------------------------------------------------------- //
+// Atomicity
+
+// Returns true if c is an atomic constraint.
+inline bool
+is_atomic(Cons const& c)
+{
+  struct fn
+  {
+    bool operator()(Cons const& c) const               { return true; }
+    bool operator()(Concept_cons const& c) const       { return false; }
+    bool operator()(Parameterized_cons const& c) const { return false; }
+    bool operator()(Conjunction_cons const& c) const   { return false; }
+    bool operator()(Disjunction_cons const& c) const   { return false; }
+  };
+  return apply(c, fn{});
+}
+
+
+// Returns true whe c is non-atomic.
+inline bool
+is_non_atomic(Cons const& c)
+{
+  return !is_atomic(c);
+}
+
+
 // -------------------------------------------------------------------------- //
 // Proof structures
 
-// A list of propositions (constraints). These are accumulated on either
-// side of a sequent. This is actually a list equipped with a side-table
-// to optimize list membership.
+// The atomic constraints of a proof. Each distinct atomic constraint
+// is assigned a dense index, which identifies it in the propositions
+// of every sequent in the proof. Constraints are unique, so atoms are
+// indexed by identity.
+struct Atom_table
+{
+  using Map = std::unordered_map<Cons const*, int>;
+  using Seq = std::vector<Cons const*>;
+
+  // Returns the index of the atom c, assigning one if needed.
+  int get(Cons const& c)
+  {
+    auto ins = map.emplace(&c, seq.size());
+    if (ins.second)
+      seq.push_back(&c);
+    return ins.first->second;
+  }
+
+  // Returns the index of the atom c, or -1 if it has not been
+  // assigned an index.
+  int find(Cons const& c) const
+  {
+    auto iter = map.find(&c);
+    return iter != map.end() ? iter->second : -1;
+  }
+
+  // Returns the atom with index n.
+  Cons const& operator[](int n) const { return *seq[n]; }
+
+  Map map;
+  Seq seq;
+};
+
+
+// A copy-on-write value. Copies share the same object until one
+// of them is modified. This allows goals in a proof to share the
+// parts of their sequents that differ.
+template<typename T>
+struct Shared
+{
+  Shared()
+    : ptr(std::make_shared<T>())
+  { }
+
+  // Returns the shared object.
+  T const& get() const { return *ptr; }
+
+  // Returns an unshared copy of the object for modification.
+  T& mut()
+  {
+    if (ptr.use_count() > 1)
+      ptr = std::make_shared<T>(*ptr);
+    return *ptr;
+  }
+
+  std::shared_ptr<T> ptr;
+};
+
+
+// A set of atoms, represented as a bitset over atom indexes. Tests
+// of membership are constant time, and testing for a common atom
+// in two sets is word-parallel.
+struct Atom_set
+{
+  using Word = std::uint64_t;
+  using Seq  = std::vector<Word>;
+
+  static constexpr int bits = 64;
+
+  // Returns true if n is in the set.
+  bool test(int n) const
+  {
+    Seq const& ws = words.get();
+    std::size_t w = n / bits;
+    return w < ws.size() && (ws[w] & (Word(1) << (n % bits)));
+  }
+
+  // Add n to the set. Returns false if n was already in the set.
+  bool insert(int n)
+  {
+    if (test(n))
+      return false;
+    Seq& ws = words.mut();
+    std::size_t w = n / bits;
+    if (w >= ws.size())
+      ws.resize(w + 1);
+    ws[w] |= Word(1) << (n % bits);
+    return true;
+  }
+
+  // Returns true if the sets have an atom in common.
+  bool intersects(Atom_set const& s) const
+  {
+    Seq const& ws1 = words.get();
+    Seq const& ws2 = s.words.get();
+    std::size_t n = std::min(ws1.size(), ws2.size());
+    for (std::size_t i = 0; i < n; ++i)
+      if (ws1[i] & ws2[i])
+        return true;
+    return false;
+  }
+
+  // Returns the index of the first atom in the set not less than n,
+  // or -1 if there is no such atom.
+  int next(int n) const
+  {
+    Seq const& ws = words.get();
+    std::size_t w = n / bits;
+    if (w >= ws.size())
+      return -1;
+    Word x = ws[w] & (~Word(0) << (n % bits));
+    while (true) {
+      if (x)
+        return w * bits + __builtin_ctzll(x);
+      if (++w == ws.size())
+        return -1;
+      x = ws[w];
+    }
+  }
+
+  Shared<Seq> words;
+};
+
+
+// A list of propositions (constraints). These are accumulated on
+// either side of a sequent. Atomic propositions are stored in a
+// set of atoms, and non-atomic propositions in a (short) list of
+// terms still to be flattened or expanded. Constraints are unique,
+// so propositions are compared by identity.
 //
-// FIXME: An unordered map on constraint *values* will be inefficient.
-// We really want to work on constraint identities, which means we
-// need to canonicalize constraints.
+// Both the atoms and terms are shared with copies of the list
+// until they are modified.
 struct Prop_list
 {
-  using Seq            = std::list<Cons const*>;
-  using iterator       = Seq::iterator;
-  using const_iterator = Seq::const_iterator;
+  using Seq = std::vector<Cons const*>;
 
-  using Map = std::unordered_map<Cons const*, iterator, Cons_hash, Cons_eq>;
+  Prop_list(Atom_table& t)
+    : tab(&t)
+  { }
 
+  // Returns the non-atomic propositions.
+  Seq const& terms() const { return seq.get(); }
 
   // Returns true if the list has a constraint that is identical
   // to c.
   bool contains(Cons const& c) const
   {
-    return map.count(&c) != 0;
-  }
-
-  // Insert a new constraint. No action is taken if the constraint
-  // is already in the set. Returns the index of the added
-  // constraint or that of the original constraint.
-  std::pair<iterator, bool> insert(Cons const& c)
-  {
-    auto iter = map.find(&c);
-    if (iter != map.end()) {
-      return {iter->second, false};
-    } else {
-      auto pos = seq.insert(seq.end(), &c);
-      map.emplace(&c, pos);
-      return {pos, true};
+    if (is_atomic(c)) {
+      int n = tab->find(c);
+      return n >= 0 && atoms.test(n);
     }
+    Seq const& ts = terms();
+    return std::find(ts.begin(), ts.end(), &c) != ts.end();
   }
 
-  // Positionally insert the constraint before pos. This does nothing if
-  // c is in the map, returing the same iterator.
-  std::pair<iterator, bool> insert(iterator pos, Cons const& c)
+  // Insert a new constraint. Non-atomic constraints are inserted
+  // into the list of terms before the position pos. No action is
+  // taken if the constraint is already in the set. Returns true
+  // if c was added as a non-atomic term.
+  bool insert(std::size_t pos, Cons const& c)
   {
-    auto iter = map.find(&c);
-    if (iter != map.end()) {
-      return {pos, false};
-    } else {
-      pos = seq.insert(pos, &c);
-      map.emplace(&c, pos);
-      return {pos, true};
+    if (is_atomic(c)) {
+      atoms.insert(tab->get(c));
+      return false;
     }
+    if (contains(c))
+      return false;
+    Seq& ts = seq.mut();
+    ts.insert(ts.begin() + pos, &c);
+    return true;
   }
 
-  // Erase the constraint from the list. This nulls the entry in the
-  // sequence, so it must be replaced.
-  iterator erase(iterator pos)
+  // Insert a new constraint after all other terms.
+  void insert(Cons const& c)
   {
-    map.erase(*pos);
-    return seq.erase(pos);
+    insert(terms().size(), c);
   }
 
-  // Replace the term in the list with c. Note that no replacement
-  // may be made if c is already in the list.
-  //
-  // Returns a pair (i, b) where i is an iterator and b a boolean
-  // value indicating successful insertion. If b is true, then i
-  // i is the position of the inserted constraint. Otherise, i the
-  // iterator past the original replaced element.
-  std::pair<iterator, bool> replace(iterator pos, Cons const& c)
+  // Replace the term at position pos with c. Returns the position
+  // of the next term to consider, which is that of c if it was
+  // inserted as a term.
+  std::size_t replace(std::size_t pos, Cons const& c)
   {
-    pos = erase(pos);
-    auto x = insert(pos, c);
-    if (x.second)
-      return x;
-    return {pos, false};
+    Seq& ts = seq.mut();
+    ts.erase(ts.begin() + pos);
+    insert(pos, c);
+    return pos;
   }
 
-  // Replace the term in the list with c1 folowed by c2. Note that
-  // no replacements may be made if c1 and c2 are already in the list.
-  //
-  // Returns a pair (i, b) where i is an iterator and b a boolean
-  // value indicating successful insertion. If b is true, then i
-  // i is the position of the first inserted constraint. Otherwise,
-  // i is the iterator past the original replaced element.
-  std::pair<iterator, bool> replace(iterator pos, Cons const& c1, Cons const& c2)
+  // Replace the term at position pos with c1 followed by c2. Returns
+  // the position of the next term to consider, which is that of the
+  // first inserted term, if any.
+  std::size_t replace(std::size_t pos, Cons const& c1, Cons const& c2)
   {
-    pos = erase(pos);
-    auto x1 = insert(pos, c1);
-    auto x2 = insert(pos, c2);
-    if (x1.second)
-      return x1;
-    if (x2.second)
-      return x2;
-    return {pos, false};
+    Seq& ts = seq.mut();
+    ts.erase(ts.begin() + pos);
+    bool b = insert(pos, c1);
+    insert(pos + b, c2);
+    return pos;
   }
 
-  // Iterators
-  iterator start()   { return (cur = seq.begin()); }
-  iterator advance() { return ++cur; }
-  iterator current() { return cur; }
-
-  iterator begin() { return seq.begin(); }
-  iterator end()   { return seq.end(); }
+  // Returns true if there are no non-atomic propositions.
+  bool is_reduced() const { return terms().empty(); }
 
-  const_iterator begin() const { return seq.begin(); }
-  const_iterator end()   const { return seq.end(); }
+  // Returns true if f(c) is true for some proposition c.
+  template<typename F>
+  bool any_of(F f) const
+  {
+    for (int n = atoms.next(0); n >= 0; n = atoms.next(n + 1))
+      if (f((*tab)[n]))
+        return true;
+    for (Cons const* c : terms())
+      if (f(*c))
+        return true;
+    return false;
+  }
 
-  Map      map;
-  Seq      seq;
-  iterator cur;
+  Atom_table* tab;   // The atoms of the proof
+  Atom_set    atoms; // Atomic propositions
+  Shared<Seq> seq;   // Non-atomic propositions
 };
 
 
 std::ostream&
-operator<<(std::ostream& os, Prop_list const& cs)
+operator<<(std::ostream& os, Prop_list const& ps)
 {
-  for (auto iter = cs.begin(); iter != cs.end(); ++iter) {
-    os << **iter;
-    if (std::next(iter) != cs.end())
+  bool first = true;
+  ps.any_of([&](Cons const& c) {
+    if (!first)
       os << ", ";
-  }
+    os << c;
+    first = false;
+    return false;
+  });
   return os;
 }
 
 
-// An iterator into a proposition lis.
-using Prop_iter       = Prop_list::iterator;
-using Prop_const_iter = Prop_list::const_iterator;
-
-
 // A sequent associates a set of antecedents with a set of
 // propositions, indicating a proof thereof (the consequences
-// follow from the antecedents).
+// follow from the antecedents). Copying a sequent is constant
+// time; the copy shares its propositions with the original.
 struct Sequent
 {
 
   // Create a sequent having the antecedent a and the consequent c.
-  Sequent(Cons const& a, Cons const& c)
+  Sequent(Atom_table& t, Cons const& a, Cons const& c)
+    : ants(t), cons(t)
   {
     ants.insert(a);
     cons.insert(c);
@@ -248,7 +391,8 @@ struct Proof
   // proof obligation.
   Proof branch()
   {
-    // Create a *copy* of the current sequence.
+    // Create a copy of the current sequent. The copy shares its
+    // propositions with the original until either is modified.
     auto iter = gs.insert(gs.end(), sequent());
 
     // And yield a new proof object.
@@ -273,56 +417,116 @@ operator<<(std::ostream& os, Proof const& p)
 }
 
 
+// Returns true when the proposition list is fully reduced.
+// That is, there are no non-atomic constraints in the list.
+inline bool
+is_reduced(Prop_list const& ps)
+{
+  return ps.is_reduced();
+}
+
+
 // -------------------------------------------------------------------------- //
-// Atomicity
+// Subsumption memoization
 
-// Returns true if c is an atomic constraint.
-inline bool
-is_atomic(Cons const& c)
+// Returns true if some proposition in `ants` is known to subsume
+// `c`. Only the known subsumers of `c` are checked.
+bool
+is_memoized(Context& cxt, Prop_list const& ants, Cons const& c)
 {
-  struct fn
-  {
-    bool operator()(Cons const& c) const               { return true; }
-    bool operator()(Concept_cons const& c) const       { return false; }
-    bool operator()(Parameterized_cons const& c) const { return false; }
-    bool operator()(Conjunction_cons const& c) const   { return false; }
-    bool operator()(Disjunction_cons const& c) const   { return false; }
+  Subsumption_state& st = cxt.subsumption_state();
+  auto iter = st.subsumers.find(&c);
+  if (iter == st.subsumers.end())
+    return false;
+  for (Cons const* a : iter->second)
+    if (ants.contains(*a))
+      return true;
+  return false;
+}
+
+
+// Returns statistics about subsumption queries.
+Subsumption_stats
+get_subsumption_stats(Context const& cxt)
+{
+  Subsumption_state const& st = cxt.subsumption_state();
+  Subsumption_stats s {
+    st.memo.size(), st.hits, st.misses,
+    st.steps, st.branches, st.peak,
+    st.bdd.size(), st.bdd.cache_size(), {}
   };
-  return apply(c, fn{});
+  s.expansions.assign(st.expansions.begin(), st.expansions.end());
+
+  // Concepts expanded equally often are ordered by name, so that the
+  // listing does not depend on the order of the table.
+  std::unordered_map<Decl const*, std::string> names;
+  for (auto const& e : s.expansions) {
+    std::stringstream ss;
+    ss << e.first->name();
+    names.emplace(e.first, ss.str());
+  }
+  auto cmp = [&names](std::pair<Decl const*, std::size_t> const& a,
+                      std::pair<Decl const*, std::size_t> const& b) {
+    if (a.second != b.second)
+      return a.second > b.second;
+    return names.at(a.first) < names.at(b.first);
+  };
+  std::sort(s.expansions.begin(), s.expansions.end(), cmp);
+  return s;
 }
 
 
-// Returns true whe c is non-atomic.
-inline bool
-is_non_atomic(Cons const& c)
+// Print statistics about subsumption queries to `os`.
+void
+dump_subsumption_stats(std::ostream& os, Context const& cxt)
 {
-  return !is_atomic(c);
+  Subsumption_stats s = get_subsumption_stats(cxt);
+  os << "subsumption: " << s.hits + s.misses << " queries, "
+     << s.hits << " memo hits, " << s.size << " memoized\n";
+  os << "proofs: " << s.steps << " steps, " << s.branches << " branches, "
+     << "peak of " << s.peak << " goals\n";
+  os << "diagrams: " << s.nodes << " nodes, "
+     << s.cached << " cached operations\n";
+  for (auto const& e : s.expansions)
+    os << "  " << e.first->name() << ": " << e.second << " expansions\n";
 }
 
 
-// Returns true when the proposition list is fully reduced.
-// That is, there are no non-atomic constraints in the list.
-//
-// FIXME: This is property can be derived during flatttening
-// and cached with each list. Do that.
-inline bool
-is_reduced(Prop_list const& ps)
+// Discard all memoized subsumption results. Decision diagrams are
+// retained.
+void
+clear_subsumption_memo(Context& cxt)
 {
-  for (Cons const* c : ps)
-    if (is_non_atomic(*c))
-      return false;
-  return true;
+  Subsumption_state& st = cxt.subsumption_state();
+  st.memo.clear();
+  st.subsumers.clear();
+  st.hits = 0;
+  st.misses = 0;
+  st.steps = 0;
+  st.branches = 0;
+  st.peak = 0;
+  st.expansions.clear();
 }
 
 
-// -------------------------------------------------------------------------- //
-// Subsumption memoization
+// Discard all decision diagrams, and the variables and diagrams
+// saved for constraints.
+void
+clear_decision_diagrams(Context& cxt)
+{
+  Subsumption_state& st = cxt.subsumption_state();
+  st.bdd.clear();
+  st.vars.clear();
+  st.diagrams.clear();
+}
 
-// TODO: Memoize the subsumption relation.
-bool
-is_memoized(Context& cxt, Cons const& a, Cons const& b)
+
+// Returns the expansion of `c`, counting it.
+inline Cons const&
+expand_concept(Context& cxt, Concept_cons const& c)
 {
-  return false;
+  ++cxt.subsumption_state().expansions[&c.declaration()];
+  return expand(cxt, c);
 }
 
 
@@ -336,8 +540,6 @@ is_memoized(Context& cxt, Cons const& a, Cons const& b)
 // satisfied (in which case we can discharge it), not satisfied
 // (in which case the proof is invalid), or unknown. This latest case
 // applies only when sequents have unexpanded propositions.
-//
-// TODO: Experiment with memoization!
 
 enum Validation
 {
@@ -364,19 +566,6 @@ Validation  validate(Context&, Prop_list&, Cons const&);
 Validation  match(Context&, Prop_list&, Cons const&);
 
 
-// Given a sequent of the form A |- C, where A and C differ
-// syntactically, try to find support for a proof of C by A.
-// This essentially means that we're going to consult a list of
-// other rules that could make such a proof valid.
-//
-// TODO: Add extra rules here.
-Validation
-find_support(Context& cxt, Cons const& a, Cons const& c)
-{
-  return invalid_proof;
-}
-
-
 // Try to derive a proof for the sequent of this form:
 //
 //    A1, A2, ..., An |- C
@@ -385,19 +574,16 @@ find_support(Context& cxt, Cons const& a, Cons const& c)
 // not occur syntactically in the list of propositions (that's checked
 // by validate(cxt, ants, c)). Therefore, we must delegate to case
 // analysis to determine if there are other rules that prove C.
+//
+// Constraints are unique, so an equivalent atom would have been
+// found by that check. There are no other rules, so there is no
+// support for C.
+//
+// TODO: Add extra rules here.
 Validation
 find_support(Context& cxt, Prop_list& ants, Cons const& c)
 {
-  // std::cout << "SUPPORT: " << c << '\n';
-  Validation r = invalid_proof;
-  for (Cons const* a : ants) {
-    Validation v = find_support(cxt, *a, c);
-    if (v == valid_proof)
-      return v;
-    if (v == incomplete_proof)
-      r = v;
-  }
-  return r;
+  return invalid_proof;
 }
 
 
@@ -405,7 +591,7 @@ find_support(Context& cxt, Prop_list& ants, Cons const& c)
 Validation
 derive(Context& cxt, Prop_list& ants, Concept_cons const& c)
 {
-  return validate(cxt, ants, expand(cxt, c));
+  return validate(cxt, ants, expand_concept(cxt, c));
 }
 
 
@@ -464,7 +650,6 @@ derive(Context& cxt, Prop_list& ants, Cons const& c)
     Validation operator()(Conjunction_cons const& c) const   { return derive(cxt, ants, c); }
     Validation operator()(Disjunction_cons const& c) const   { return derive(cxt, ants, c); }
   };
-  // std::cout << "DERIVE: " << c << '\n';
   return apply(c, fn{cxt, ants});
 }
 
@@ -493,10 +678,8 @@ validate(Context& cxt, Prop_list& ants, Cons const& c)
 
   // If we had previously memoized the proof, then use that
   // result.
-  for (Cons const* a : ants) {
-    if (is_memoized(cxt, *a, c))
-      return valid_proof;
-  }
+  if (is_memoized(cxt, ants, c))
+    return valid_proof;
 
   // Actually derive a proof of C from AS. If the result
   // is invalid, by the thre are incomplete terms, then
@@ -517,21 +700,25 @@ validate(Context& cxt, Prop_list& ants, Cons const& c)
 // The sequent is a valid proof if any Ai prove any Ci. The sequent
 // is invalid only when all Ai provie no Ci. The proof is incomplete
 // when it is invalid, but some Ai is a non-atomic proposition.
+//
+// The sequent is trivially valid when an atom occurs on both sides.
+// That is checked for all atoms at once.
 Validation
 validate(Context& cxt, Sequent& s)
 {
   Prop_list& as = s.antecedents();
   Prop_list& cs = s.consequents();
+  if (as.atoms.intersects(cs.atoms))
+    return valid_proof;
 
   Validation r = invalid_proof;
-  for (Cons const* c : cs) {
-    Validation v = validate(cxt, as, *c);
-    if (v == valid_proof)
-      return v;
+  bool valid = cs.any_of([&](Cons const& c) {
+    Validation v = validate(cxt, as, c);
     if (v == incomplete_proof)
       r = v;
-  }
-  return r;
+    return v == valid_proof;
+  });
+  return valid ? valid_proof : r;
 }
 
 
@@ -550,9 +737,10 @@ validate(Proof& p)
     Validation v = validate(cxt, *iter);
     if (v == valid_proof)
       iter = goals.discharge(iter);
-    else if (v == invalid_proof || v == incomplete_proof)
+    else if (v == invalid_proof)
       return v;
-    ++iter;
+    else
+      ++iter;
   }
   if (goals.empty())
     return valid_proof;
@@ -568,158 +756,134 @@ validate(Proof& p)
 // the constraint sets on the left and right of a sequent. This will
 // never produce sub-goals.
 
-Prop_iter flatten_left(Proof, Cons const&);
-Prop_iter flatten_right(Proof, Cons const&);
-
-
-inline Prop_iter
-advance(Prop_list& ps)
-{
-  return ps.advance();
-}
-
-
-inline Prop_iter
-replace(Prop_list& ps, Cons const& c)
-{
-  auto x = ps.replace(ps.current(), c);
-  return x.first;
-}
-
-
-inline Prop_iter
-replace(Prop_list& ps, Cons const& c1, Cons const& c2)
-{
-  auto x = ps.replace(ps.current(), c1, c2);
-  return x.first;
-}
+std::size_t flatten_left(Prop_list&, std::size_t, Cons const&);
+std::size_t flatten_right(Prop_list&, std::size_t, Cons const&);
 
 
 // Do nothing for atomic constraints.
-Prop_iter
-flatten_left_atom(Proof p, Cons const& c)
+inline std::size_t
+flatten_left_atom(Prop_list& ps, std::size_t n, Cons const& c)
 {
-  return advance(p.sequent().antecedents());
+  return n + 1;
 }
 
 
 // Replace the current consequent with its operand (maybe).
 // Parameterized constraints are essentially transparent, so
 // they can be reduced immediately.
-Prop_iter
-flatten_left_lambda(Proof p, Parameterized_cons const& c)
+inline std::size_t
+flatten_left_lambda(Prop_list& ps, std::size_t n, Parameterized_cons const& c)
 {
-  Cons const& c1 = c.constraint();
-  return replace(p.sequent().antecedents(), c1);
+  return ps.replace(n, c.constraint());
 }
 
 
 // Replace the current antecedent with its operands (maybe).
-Prop_iter
-flatten_left_conjunction(Proof p, Conjunction_cons const& c)
+inline std::size_t
+flatten_left_conjunction(Prop_list& ps, std::size_t n, Conjunction_cons const& c)
 {
-  Cons const& c1 = c.left();
-  Cons const& c2 = c.right();
-  return replace(p.sequent().antecedents(), c1, c2);
+  return ps.replace(n, c.left(), c.right());
 }
 
 
 // Advance to the next term so we don't produce subgoals.
-Prop_iter
-flatten_left_disjunction(Proof p, Disjunction_cons const& c)
+inline std::size_t
+flatten_left_disjunction(Prop_list& ps, std::size_t n, Disjunction_cons const& c)
 {
-  return advance(p.sequent().antecedents());
+  return n + 1;
 }
 
 
-// Select an appropriate action for the current proposition.
-Prop_iter
-flatten_left(Proof p, Cons const& c)
+// Select an appropriate action for the proposition at position
+// n, returning the position of the next proposition.
+std::size_t
+flatten_left(Prop_list& ps, std::size_t n, Cons const& c)
 {
   struct fn
   {
-    Proof p;
-    Prop_iter operator()(Cons const& c)               { return flatten_left_atom(p, c); }
-    Prop_iter operator()(Parameterized_cons const& c) { return flatten_left_lambda(p, c); }
-    Prop_iter operator()(Conjunction_cons const& c)   { return flatten_left_conjunction(p, c); }
-    Prop_iter operator()(Disjunction_cons const& c)   { return flatten_left_disjunction(p, c); }
+    Prop_list&  ps;
+    std::size_t n;
+    std::size_t operator()(Cons const& c)               { return flatten_left_atom(ps, n, c); }
+    std::size_t operator()(Parameterized_cons const& c) { return flatten_left_lambda(ps, n, c); }
+    std::size_t operator()(Conjunction_cons const& c)   { return flatten_left_conjunction(ps, n, c); }
+    std::size_t operator()(Disjunction_cons const& c)   { return flatten_left_disjunction(ps, n, c); }
   };
-  return apply(c, fn{p});
+  return apply(c, fn{ps, n});
 }
 
 
-// Flatten all propositions in the antecedents.
+// Flatten all propositions in the antecedents. Only non-atomic
+// terms need to be considered.
 void
-flatten_left(Proof p, Sequent& s)
+flatten_left(Sequent& s)
 {
   Prop_list& as = s.antecedents();
-  auto ai = as.start();
-  while (ai != as.end())
-    ai = flatten_left(p, **ai);
+  std::size_t n = 0;
+  while (n != as.terms().size())
+    n = flatten_left(as, n, *as.terms()[n]);
 }
 
 
 // Advance to the next goal.
-Prop_iter
-flatten_right_atom(Proof p, Cons const& c)
+inline std::size_t
+flatten_right_atom(Prop_list& ps, std::size_t n, Cons const& c)
 {
-  return advance(p.sequent().consequents());
+  return n + 1;
 }
 
 
 // Replace the current consequent with its operand (maybe).
 // Parameterized constraints are essentially transparent, so
 // they can be reduced immediately.
-Prop_iter
-flatten_right_lambda(Proof p, Parameterized_cons const& c)
+inline std::size_t
+flatten_right_lambda(Prop_list& ps, std::size_t n, Parameterized_cons const& c)
 {
-  Cons const& c1 = c.constraint();
-  return replace(p.sequent().consequents(), c1);
+  return ps.replace(n, c.constraint());
 }
 
 
 // Advance to the next term so we don't produce subgoals.
-Prop_iter
-flatten_right_conjunction(Proof p, Conjunction_cons const& c)
+inline std::size_t
+flatten_right_conjunction(Prop_list& ps, std::size_t n, Conjunction_cons const& c)
 {
-  return advance(p.sequent().consequents());
+  return n + 1;
 }
 
 
 // Replace the current antecedent with its operands (maybe).
-Prop_iter
-flatten_right_disjunction(Proof p, Disjunction_cons const& c)
+inline std::size_t
+flatten_right_disjunction(Prop_list& ps, std::size_t n, Disjunction_cons const& c)
 {
-  Cons const& c1 = c.left();
-  Cons const& c2 = c.right();
-  return replace(p.sequent().consequents(), c1, c2);
+  return ps.replace(n, c.left(), c.right());
 }
 
 
-// Select an appropriate action for the current proposition.
-Prop_iter
-flatten_right(Proof p, Cons const& c)
+// Select an appropriate action for the proposition at position
+// n, returning the position of the next proposition.
+std::size_t
+flatten_right(Prop_list& ps, std::size_t n, Cons const& c)
 {
   struct fn
   {
-    Proof p;
-    Prop_iter operator()(Cons const& c)               { return flatten_right_atom(p, c); }
-    Prop_iter operator()(Parameterized_cons const& c) { return flatten_right_lambda(p, c); }
-    Prop_iter operator()(Conjunction_cons const& c)   { return flatten_right_conjunction(p, c); }
-    Prop_iter operator()(Disjunction_cons const& c)   { return flatten_right_disjunction(p, c); }
+    Prop_list&  ps;
+    std::size_t n;
+    std::size_t operator()(Cons const& c)               { return flatten_right_atom(ps, n, c); }
+    std::size_t operator()(Parameterized_cons const& c) { return flatten_right_lambda(ps, n, c); }
+    std::size_t operator()(Conjunction_cons const& c)   { return flatten_right_conjunction(ps, n, c); }
+    std::size_t operator()(Disjunction_cons const& c)   { return flatten_right_disjunction(ps, n, c); }
   };
-  return apply(c, fn{p});
+  return apply(c, fn{ps, n});
 }
 
 
 // Flatten all terms in the consequents.
 void
-flatten_right(Proof p, Sequent& s)
+flatten_right(Sequent& s)
 {
   Prop_list& cs = s.consequents();
-  auto ci = cs.start();
-  while (ci != cs.end())
-    ci = flatten_right(p, **ci);
+  std::size_t n = 0;
+  while (n != cs.terms().size())
+    n = flatten_right(cs, n, *cs.terms()[n]);
 }
 
 
@@ -736,8 +900,8 @@ void
 flatten(Proof p)
 {
   for (Sequent& s : p.goals()) {
-    flatten_left(p, s);
-    flatten_right(p, s);
+    flatten_left(s);
+    flatten_right(s);
   }
 }
 
@@ -747,135 +911,273 @@ flatten(Proof p)
 // This tries to select an antecedent to expand. In general, we prefer
 // to expand concepts before disjunctions unless the concept containts
 // disjunctions.
-//
-// TODO: We need to cache properties of concepts so that we can quickly
-// determine the relative cost of expanding those terms.
 
 
-// Returns true if a is a better choice for expansion than b. In general,
-// we always prefer to expand a concept before a disjunction UNLESS
-//
-// - the concept contains nested disjunction
-// - the disjunction is relatively shallow
-//
-// Note that a and b can be atomic. We never prefer to constrain
-// an atomic expression. In other words, a concept is better
-// than anything except a concept. A disjunction is only better
-// than atomic constraint.
+// The estimated cost of expanding a term. Costs are compared
+// lexicographically; lower costs are better.
+using Expansion_cost = std::tuple<int, int, int, int>;
+
+
+// Returns the estimated cost of expanding `c`. Concepts are always
+// expanded before disjunctions: expanding a concept never creates
+// new goals, and it may expose atoms that make splitting the goal
+// unnecessary. Among concepts, we prefer those whose definitions
+// add the fewest concept checks, then the shallowest disjunctions,
+// then the fewest atoms. Among disjunctions, we prefer the shallow
+// and small, since every split doubles the work that follows.
 //
-// TODO: Implement ordering heuristics.
-inline bool
-is_better_expansion(Cons const* a, Cons const* b)
+// Atomic constraints are never expanded.
+Expansion_cost
+expansion_cost(Context& cxt, Cons const& c)
 {
-  // A concept is better than anything other than another concept.
-  if (is<Concept_cons>(a)) {
-    if (is<Concept_cons>(b))
-      return false;
-    return true;
+  if (Concept_cons const* k = as<Concept_cons>(&c)) {
+    Constraint_props const& p = get_concept_properties(cxt, k->declaration());
+    return Expansion_cost(0, p.checks, p.depth, p.atoms);
+  }
+  if (is<Disjunction_cons>(&c)) {
+    Constraint_props p = get_constraint_properties(c);
+    return Expansion_cost(1, p.depth, p.checks, p.atoms);
   }
+  return Expansion_cost(2, 0, 0, 0);
+}
 
-  // A disjunction is better than atomic constraints.
-  if (is<Disjunction_cons>(a))
-    return is_atomic(*b);
 
-  return false;
+// Returns the position of the best term in `ts` to expand, or the
+// end of the sequence if no term can be expanded.
+template<typename Seq, typename P>
+typename Seq::const_iterator
+select_expansion(Context& cxt, Seq const& ts, P pred)
+{
+  auto best = ts.end();
+  Expansion_cost min;
+  for (auto iter = ts.begin(); iter != ts.end(); ++iter) {
+    if (!pred(**iter))
+      continue;
+    Expansion_cost cost = expansion_cost(cxt, **iter);
+    if (best == ts.end() || cost < min) {
+      best = iter;
+      min = cost;
+    }
+  }
+  return best;
 }
 
 
-// Select a term in the sequent to expand. Collect all non-atomic
-// terms and select the best term to expand.
+// Select a term in the current goal to expand. Only non-atomic
+// terms are candidates, so a reduced sequent is not expanded.
+//
+// Expanding a disjunction in the antecedents splits the goal: the
+// sequent A \/ B |- C is proven by proving both A |- C and B |- C.
 //
 // NOTE: We should never have conjunctions or parameterized constraints
 // as non-atomic propositions in the list of antecedents. Those must
 // have been flattened during the previous pass on the proof state.
-//
-// TODO: If we cache the "flattness" state, then we could skip the
-// ordering step since no non-atomic constraint would be expanded.
 void
-expand_left(Proof& p, Sequent& s)
+expand_left(Proof p)
 {
-  Prop_list& ps = s.antecedents();
-
-  // Select the best candidate to expand. Only expand if
-  // the selected element is non-atomic.
-  auto best = std::min_element(ps.begin(), ps.end(), is_better_expansion);
-  if (Concept_cons const* c = as<Concept_cons>(*best))
-    ps.replace(best, expand(p.context(), *c));
-  else if (Disjunction_cons const* d = as<Disjunction_cons>(*best))
-    ps.replace(best, d->left(), d->right());
+  Subsumption_state& st = p.context().subsumption_state();
+  Prop_list& ps = p.antecedents();
+  if (ps.is_reduced())
+    return;
+
+  // Select the best candidate to expand.
+  auto pred = [](Cons const& c) { return !is_atomic(c); };
+  Prop_list::Seq const& ts = ps.terms();
+  auto best = select_expansion(p.context(), ts, pred);
+  std::size_t n = best - ts.begin();
+  ++st.steps;
+  if (Concept_cons const* c = as<Concept_cons>(*best)) {
+    ps.replace(n, expand_concept(p.context(), *c));
+  } else if (Disjunction_cons const* d = as<Disjunction_cons>(*best)) {
+    ++st.branches;
+    Proof q = p.branch();
+    q.antecedents().replace(n, d->right());
+    ps.replace(n, d->left());
+  }
 }
 
 
-// Find a concept on the right hand side, and expand it.
-//
-// FIXME: This only really works if a concept appears in the
-// consequents of the goal. Any degree of conunjunctive nesting
-// will ensure that this does not happen.
+// Select the cheapest concept in the consequents and expand it. This
+// is only done once the antecedents are reduced: until then, a concept
+// may be matched as a whole, which is cheaper than matching any of
+// its expansion. Disjunctions in the consequents never split goals,
+// so only concepts are expanded.
 void
-expand_right(Proof& p, Sequent& s)
+expand_right(Proof p)
 {
-  Prop_list& ps = s.consequents();
-
-  // Replace the first concept.
-  auto cmp = [](Cons const* c) { return is<Concept_cons>(c); };
-  auto iter = std::find_if(ps.begin(), ps.end(), cmp);
-  if (iter != ps.end()) {
-    // std::cout << "RIGHT: " << **iter << '\n';
-    Concept_cons const& c = cast<Concept_cons>(**iter);
-    ps.replace(iter, expand(p.context(), c));
+  if (!p.antecedents().is_reduced())
+    return;
+  Prop_list& ps = p.consequents();
+  auto pred = [](Cons const& c) { return is<Concept_cons>(&c); };
+  Prop_list::Seq const& ts = ps.terms();
+  auto best = select_expansion(p.context(), ts, pred);
+  if (best != ts.end()) {
+    ++p.context().subsumption_state().steps;
+    Concept_cons const& c = cast<Concept_cons>(**best);
+    ps.replace(best - ts.begin(), expand_concept(p.context(), c));
   }
 }
 
 
-// Select, in each goal, a term to expand (and expand it).
+// Select, in each goal, a term to expand (and expand it). Goals
+// created by splitting a goal are not expanded until the next step.
 //
 // TODO: There are other interesting strategies. For example,
 // we might choose to expand all concepts first.
 void
 expand(Proof p)
 {
-  for (Sequent& s : p.goals()) {
-    expand_left(p, s);
-    // expand_right(p, s);
+  Goal_list& gs = p.goals();
+  Goal_iter iter = gs.begin();
+  for (std::size_t n = gs.size(); n != 0; --n, ++iter) {
+    expand_left(Proof(p.context(), gs, iter));
+    expand_right(Proof(p.context(), gs, iter));
   }
 }
 
 
+// -------------------------------------------------------------------------- //
+// Decision diagrams
+//
+// A constraint is translated into a binary decision diagram over
+// its atomic constraints. Concepts and parameterized constraints
+// are transparent: they are translated as their expansion. The
+// diagram of each constraint is saved, so each concept is expanded
+// and translated once.
+//
+// Because atoms are compared by identity, a subsumes c exactly when
+// the formula a => c is valid in propositional logic. This is also
+// what the sequent engine decides.
+//
+// Nodes are never freed, so when the diagrams exceed the node limit,
+// they are all discarded and the query is abandoned. Later queries
+// start over with an empty package.
+
+
+Bdd::Node to_bdd(Context&, Cons const&);
+
+
+// Returns the variable for an atomic constraint.
+inline Bdd::Node
+to_bdd_atom(Context& cxt, Cons const& c)
+{
+  Subsumption_state& st = cxt.subsumption_state();
+  auto ins = st.vars.emplace(&c, st.vars.size());
+  return st.bdd.var(ins.first->second);
+}
+
+
+inline Bdd::Node
+to_bdd_conjunction(Context& cxt, Conjunction_cons const& c)
+{
+  Bdd::Node n1 = to_bdd(cxt, c.left());
+  Bdd::Node n2 = to_bdd(cxt, c.right());
+  return cxt.subsumption_state().bdd.conj(n1, n2);
+}
+
+
+inline Bdd::Node
+to_bdd_disjunction(Context& cxt, Disjunction_cons const& c)
+{
+  Bdd::Node n1 = to_bdd(cxt, c.left());
+  Bdd::Node n2 = to_bdd(cxt, c.right());
+  return cxt.subsumption_state().bdd.disj(n1, n2);
+}
+
+
+// Returns the decision diagram for the constraint `c`.
+Bdd::Node
+to_bdd(Context& cxt, Cons const& c)
+{
+  Subsumption_state& st = cxt.subsumption_state();
+  struct fn
+  {
+    Context& cxt;
+    Bdd::Node operator()(Cons const& c) const               { return to_bdd_atom(cxt, c); }
+    Bdd::Node operator()(Concept_cons const& c) const       { return to_bdd(cxt, expand_concept(cxt, c)); }
+    Bdd::Node operator()(Parameterized_cons const& c) const { return to_bdd(cxt, c.constraint()); }
+    Bdd::Node operator()(Conjunction_cons const& c) const   { return to_bdd_conjunction(cxt, c); }
+    Bdd::Node operator()(Disjunction_cons const& c) const   { return to_bdd_disjunction(cxt, c); }
+  };
+
+  auto iter = st.diagrams.find(&c);
+  if (iter != st.diagrams.end())
+    return iter->second;
+  Bdd::Node n = apply(c, fn{cxt});
+  std::size_t lim = st.limits.nodes;
+  if (lim && st.bdd.size() > lim) {
+    clear_decision_diagrams(cxt);
+    throw Limitation_error("exceeded decision diagram size limit");
+  }
+  st.diagrams.emplace(&c, n);
+  return n;
+}
+
+
+// Returns true if the implication a => c is valid.
+bool
+decide(Context& cxt, Cons const& a, Cons const& c)
+{
+  Bdd::Node n1 = to_bdd(cxt, a);
+  Bdd::Node n2 = to_bdd(cxt, c);
+  return cxt.subsumption_state().bdd.implies(n1, n2);
+}
+
+
 // -------------------------------------------------------------------------- //
 // Subsumption
 
+// Throw a Limitation_error if the proof that `a` subsumes `c` exceeds
+// any of the limits in the context. The proof has `g` goals, and has
+// taken `n` steps since `start`. A step is the expansion of one term,
+// as counted in the statistics. Goals share most of their propositions,
+// so the goal limit can be large.
+void
+check_limits(Context& cxt, Cons const& a, Cons const& c,
+             std::size_t g, std::size_t n,
+             std::chrono::steady_clock::time_point start)
+{
+  Subsumption_limits const& lim = cxt.subsumption_state().limits;
+  if (lim.goals && g > lim.goals)
+    throw Limitation_error("proof that '{}' subsumes '{}' "
+                           "exceeds the limit of {} goals", a, c, lim.goals);
+  if (lim.steps && n > lim.steps)
+    throw Limitation_error("proof that '{}' subsumes '{}' "
+                           "exceeds the limit of {} steps", a, c, lim.steps);
+  if (lim.time) {
+    auto t = std::chrono::steady_clock::now() - start;
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t);
+    if (std::size_t(ms.count()) > lim.time)
+      throw Limitation_error("proof that '{}' subsumes '{}' "
+                             "exceeds the limit of {}ms", a, c, lim.time);
+  }
+}
+
 
-// Returns true if a subsumes c.
+// Construct a proof that a subsumes c, returning true if the
+// proof is valid.
 //
 // TODO: How do I know when I've exhuasted all opportunities.
 bool
-subsumes(Context& cxt, Cons const& a, Cons const& c)
+prove(Context& cxt, Cons const& a, Cons const& c)
 {
-  // Check the easy cases before setting up a proof.
-  if (is_equivalent(a, c))
-    return true;
-  if (is_memoized(cxt, a, c))
-    return true;
-
-  // Alas... no quick check. We have to prove the implication.
-  Goal_list goals(Sequent(a, c));
+  Subsumption_state& st = cxt.subsumption_state();
+  auto start = std::chrono::steady_clock::now();
+  Atom_table atoms;
+  Goal_list goals(Sequent(atoms, a, c));
   Proof p(cxt, goals);
-  // std::cout << "INIT: " << p.sequent() << '\n';
 
   // Continue manipulating the proof state until we know that
   // the implication is valid or not.
-  int n = 1;
+  std::size_t n = st.steps;
   Validation v;
   do {
     // Opportunistically flatten sequents in each goal.
     flatten(p);
-    // std::cout << "------------\n";
-    // std::cout << "STEP " << n << ": " << p.sequent() << '\n';
 
     // Having done that, determine if the proof is valid (or not).
     // In either case, we can stop.
     v = validate(p);
-    // std::cout << "VALID? " << v << '\n';
     if (v == valid_proof)
       return true;
     if (v == invalid_proof)
@@ -883,19 +1185,45 @@ subsumes(Context& cxt, Cons const& a, Cons const& c)
 
     // Otherwise, select a term in each goal to expand.
     expand(p);
-    ++n;
-
-    // TODO: Actually diagnose implementation limits. Note that the
-    // real limiting factor is going to be the goal size, not
-    // the step count.
-    if (goals.size() > 32)
-      throw Limitation_error("exceeded proof subgoal limit");
-    if (n > 1024)
-      throw Limitation_error("exceeded proof step limit");
+    st.peak = std::max(st.peak, goals.size());
+    check_limits(cxt, a, c, goals.size(), st.steps - n, start);
   } while (v == incomplete_proof);
 
   return false;
 }
 
 
+// Returns true if a subsumes c. The result of each query, whether
+// true or false, is memoized. Queries that exceed implementation
+// limits are not. The query is decided by the context's selected
+// engine.
+bool
+subsumes(Context& cxt, Cons const& a, Cons const& c)
+{
+  // Check the easy cases before setting up a proof.
+  if (is_equivalent(a, c))
+    return true;
+
+  Subsumption_state& st = cxt.subsumption_state();
+  Subsumption_state::Cons_pair key(&a, &c);
+  auto iter = st.memo.find(key);
+  if (iter != st.memo.end()) {
+    ++st.hits;
+    return iter->second;
+  }
+  ++st.misses;
+
+  // Alas... no quick check. We have to prove the implication.
+  bool r;
+  if (st.engine == bdd_engine)
+    r = decide(cxt, a, c);
+  else
+    r = prove(cxt, a, c);
+  st.memo.emplace(key, r);
+  if (r)
+    st.subsumers[&c].push_back(&a);
+  return r;
+}
+
+
 } // namespace banjo
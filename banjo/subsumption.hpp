@@ -5,18 +5,119 @@
 #define BANJO_SUBSUMPTION_HPP
 
 #include "prelude.hpp"
+#include "bdd.hpp"
+
+#include <boost/functional/hash.hpp>
+
+#include <iosfwd>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 
 namespace banjo
 {
 
 struct Cons;
+struct Decl;
 struct Context;
 
 
+// The procedures used to decide subsumption. The sequent engine
+// constructs a proof of the implication, expanding concepts as
+// needed. The diagram engine decides the implication using binary
+// decision diagrams of the fully expanded constraints. Both give
+// the same answers.
+enum Subsumption_engine : char
+{
+  sequent_engine,
+  bdd_engine,
+};
+
+
+// Limits on the resources used to prove a single subsumption query.
+// A proof exceeding any limit is abandoned with a Limitation_error.
+// A limit of 0 is unlimited.
+//
+// The node limit applies to the decision diagrams shared by all
+// queries. When it is exceeded, the diagrams are discarded.
+struct Subsumption_limits
+{
+  std::size_t goals; // The maximum number of goals
+  std::size_t steps; // The maximum number of terms expanded
+  std::size_t time;  // The maximum time, in milliseconds
+  std::size_t nodes; // The maximum number of diagram nodes
+};
+
+
+// The subsumption state of a context.
+//
+// The result of each query is memoized for the (unique) antecedent
+// and consequent constraints, and the known subsumers of each
+// consequent are listed. Statistics are kept for each proof.
+//
+// For the diagram engine, each atomic constraint is assigned a
+// variable, and the diagram of each constraint is saved.
+struct Subsumption_state
+{
+  using Cons_pair = std::pair<Cons const*, Cons const*>;
+  using Memo_map = std::unordered_map<
+    Cons_pair, bool, boost::hash<Cons_pair>
+  >;
+  using Subsumer_map =
+    std::unordered_map<Cons const*, std::vector<Cons const*>>;
+  using Count_map = std::unordered_map<Decl const*, std::size_t>;
+  using Bdd_map = std::unordered_map<Cons const*, int>;
+
+  Subsumption_state()
+    : hits(0), misses(0), steps(0), branches(0), peak(0),
+      limits {4096, 1024, 0, 1 << 22}, engine(sequent_engine)
+  { }
+
+  Memo_map           memo;       // Memoized subsumption results
+  Subsumer_map       subsumers;  // Known subsumers of each constraint
+  std::size_t        hits;       // Queries found in the memo
+  std::size_t        misses;     // Queries proved
+  std::size_t        steps;      // Terms expanded in proofs
+  std::size_t        branches;   // Goals created in proofs
+  std::size_t        peak;       // Largest number of goals in a proof
+  Count_map          expansions; // Expansions of each concept in proofs
+  Subsumption_limits limits;     // Resource limits for each proof
+  Subsumption_engine engine;     // The subsumption procedure
+  Bdd                bdd;        // Decision diagrams for constraints
+  Bdd_map            vars;       // Variables of atomic constraints
+  Bdd_map            diagrams;   // Diagrams of constraints
+};
+
+
 bool subsumes(Context&, Cons const&, Cons const&);
 
 
+// Statistics for subsumption queries, accumulated since the memo was
+// last cleared. Concepts are listed with the number of times each was
+// expanded, most often first.
+struct Subsumption_stats
+{
+  using Expansion_list = std::vector<std::pair<Decl const*, std::size_t>>;
+
+  std::size_t    size;       // The number of memoized results
+  std::size_t    hits;       // Queries answered by the memo
+  std::size_t    misses;     // Queries requiring a proof
+  std::size_t    steps;      // Terms expanded by the sequent engine
+  std::size_t    branches;   // Goals created by splitting disjunctions
+  std::size_t    peak;       // The largest number of goals in a proof
+  std::size_t    nodes;      // Nodes in the decision diagrams
+  std::size_t    cached;     // Memoized decision diagram operations
+  Expansion_list expansions; // Expansions of each concept
+};
+
+
+Subsumption_stats get_subsumption_stats(Context const&);
+void              dump_subsumption_stats(std::ostream&, Context const&);
+void              clear_subsumption_memo(Context&);
+void              clear_decision_diagrams(Context&);
+
+
 } // namespace banjo
 
 
@@ -104,24 +104,59 @@ initialize_template_parameters(Context& cxt, Decl_list& parms, Term_list& args)
 // -------------------------------------------------------------------------- //
 // Template specialization
 
+// Returns the canonical form of a converted template argument.
+// Initializers and conversions are stripped from value arguments
+// so that the argument is compared by the value it was written as,
+// not by the sequence of conversions used to produce it.
+//
+// TODO: Reduce value arguments to constants. Currently, equal
+// values that are spelled differently (e.g., `1` and `true` for
+// a bool parameter) yield different specializations.
+Term&
+canonicalize_template_argument(Term& arg)
+{
+  Expr* e = as<Expr>(&arg);
+  if (!e)
+    return arg;
+  while (true) {
+    if (Copy_init* i = as<Copy_init>(e))
+      e = &i->expression();
+    else if (Bind_init* i = as<Bind_init>(e))
+      e = &i->expression();
+    else if (Conv* c = as<Conv>(e))
+      e = &c->source();
+    else
+      return *e;
+  }
+}
+
+
+Term_list
+canonicalize_template_arguments(Term_list& args)
+{
+  Term_list ret;
+  ret.reserve(args.size());
+  for (Term& a : args)
+    ret.push_back(canonicalize_template_argument(a));
+  return ret;
+}
+
+
 // TODO: This is basically what happens for every single declaration.
 // Find a way of generalizing it.
+//
+// Note that `args` are the converted template arguments. The
+// specialization is named by their canonical form.
 Decl&
-specialize_variable(Context& cxt, Template_decl& tmp, Variable_decl& d, Term_list& orig)
+specialize_variable(Context& cxt, Template_decl& tmp, Variable_decl& d, Term_list& args)
 {
   Builder build(cxt);
 
-  // Convert parameters.
-  Decl_list& parms = tmp.parameters();
-  Term_list args = initialize_template_parameters(cxt, parms, orig);
-
   // Create the specialization name.
-  Name& n = build.get_template_id(tmp, args);
+  Decl_list& parms = tmp.parameters();
+  Name& n = build.get_template_id(tmp, canonicalize_template_arguments(args));
 
   // Substitute into the type.
-  //
-  // TODO: Don't substitute or re-declare if we've already
-  // created a specialization for these arguments.
   Substitution sub(parms, args);
   Type& t = substitute(cxt, d.type(), sub);
 
@@ -130,21 +165,15 @@ specialize_variable(Context& cxt, Template_decl& tmp, Variable_decl& d, Term_lis
 
 
 Decl&
-specialize_function(Context& cxt, Template_decl& tmp, Function_decl& d, Term_list& orig)
+specialize_function(Context& cxt, Template_decl& tmp, Function_decl& d, Term_list& targs)
 {
   Builder build(cxt);
 
-  // Convert parameters.
-  Decl_list& tparms = tmp.parameters();
-  Term_list targs = initialize_template_parameters(cxt, tparms, orig);
-
   // Create the specialization name.
-  Name& n = build.get_template_id(tmp, targs);
+  Decl_list& tparms = tmp.parameters();
+  Name& n = build.get_template_id(tmp, canonicalize_template_arguments(targs));
 
   // Substitute into the type.
-  //
-  // TODO: Don't substitute or re-declare if we've already
-  // created a specialization for these arguments.
   Substitution sub(tparms, targs);
 
   // Substitute through parameters.
@@ -167,22 +196,16 @@ specialize_function(Context& cxt, Template_decl& tmp, Function_decl& d, Term_lis
 
 
 Decl&
-specialize_class(Context& cxt, Template_decl& tmp, Class_decl& d, Term_list& orig)
+specialize_class(Context& cxt, Template_decl& tmp, Class_decl& d, Term_list& args)
 {
   Builder build(cxt);
-
-  // Convert parameters.
-  Decl_list& parms = tmp.parameters();
-  Term_list args = initialize_template_parameters(cxt, parms, orig);
-
-  Name& n = build.get_template_id(tmp, args);
-
+  Name& n = build.get_template_id(tmp, canonicalize_template_arguments(args));
   return build.make_class(n);
 }
 
 
 // Specialize a templated declaration `decl` (`decl` is parameterized
-// by the template `tmp`).
+// by the template `tmp`) for the converted template arguments `args`.
 //
 // This is distinct from substitution. Here, we produce a new declaration
 // with a distinct name. We do not, however, substitute into its
@@ -211,13 +234,124 @@ specialize_declaration(Context& cxt, Template_decl& tmp, Decl& decl, Term_list&
 // Produce an implicit specialization of the template declaration
 // `d`, given a list of template arguments.
 //
+// Specializations are created once for each distinct list of
+// canonical template arguments. Subsequent requests return the
+// previously created declaration. Canonicalization strips the
+// initializers and conversions applied to an argument, so the
+// written arguments usually name the same specialization as the
+// converted ones, and are looked up before conversion. Only when
+// that fails are the arguments converted and looked up again.
+//
 // Note that this only builds the declaration. It does not fully
 // instantiate the definition.
+//
+// It is an error if the specialization is already in progress,
+// or if the instantiation depth limit is exceeded.
 Decl&
 specialize_template(Context& cxt, Template_decl& tmp, Term_list& args)
 {
+  Template_decl::Specialization_map& specs = tmp.specializations();
+  auto iter = specs.find(canonicalize_template_arguments(args));
+  if (iter != specs.end()) {
+    ++tmp.hits;
+    return *iter->second;
+  }
+
+  Term_list conv = initialize_template_parameters(cxt, tmp.parameters(), args);
+  Term_list key = canonicalize_template_arguments(conv);
+  iter = specs.find(key);
+  if (iter != specs.end()) {
+    ++tmp.hits;
+    return *iter->second;
+  }
+  ++tmp.misses;
+
+  // Specialization may require the specialization of other templates
+  // (e.g., through constraints). Diagnose recursive specializations.
+  Builder build(cxt);
+  Enter_instantiation inst(cxt, build.get_template_id(tmp, key));
+
   Decl& decl = tmp.parameterized_declaration();
-  return specialize_declaration(cxt, tmp, decl, args);
+  Decl& spec = specialize_declaration(cxt, tmp, decl, conv);
+  specs.emplace(std::move(key), &spec);
+  tmp.args.emplace(&spec, std::move(conv));
+  return spec;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Template instantiation
+//
+// Specialization produces only a declaration. The definition of a
+// specialization is instantiated only when it is needed (e.g., when
+// a function is referenced). Instantiations are requested during
+// translation and performed at the end of the translation unit, or
+// when required for evaluation.
+
+
+// Request the instantiation of the definition of the specialization
+// `d`. Only function specializations with non-dependent arguments
+// are instantiated. Repeated requests for the same specialization
+// are ignored.
+void
+request_instantiation(Context& cxt, Decl& d)
+{
+  if (!is<Function_decl>(&d))
+    return;
+  Template_id* id = as<Template_id>(&d.name());
+  if (!id)
+    return;
+  for (Term& t : id->arguments())
+    if (is_dependent(t))
+      return;
+  Template_state& st = cxt.template_state();
+  if (st.requested.insert(&d).second)
+    st.pending.push_back(&d);
+}
+
+
+// Instantiate the definition of the function specialization `d` by
+// substituting its converted template arguments into the definition
+// of its template. References to the parameters of the pattern are
+// rebound to those of the specialization. Returns false if the
+// template is not yet defined.
+bool
+instantiate_function(Context& cxt, Function_decl& d)
+{
+  Template_id& id = cast<Template_id>(d.name());
+  Template_decl& tmp = id.declaration();
+  Function_decl& pat = cast<Function_decl>(tmp.parameterized_declaration());
+  if (!pat.is_definition())
+    return false;
+
+  Substitution sub(tmp.parameters(), tmp.specialization_arguments(d));
+  auto pi = pat.parameters().begin();
+  for (Decl& p : d.parameters()) {
+    sub.bind(*pi, p);
+    ++pi;
+  }
+  d.def = &substitute(cxt, pat.definition(), sub);
+  return true;
+}
+
+
+// Instantiate the definitions of pending specializations, in the
+// order they were requested. Instantiation may request further
+// instantiations (e.g., for references to specializations in the
+// definition), which are also performed. Specializations whose
+// templates are not yet defined remain pending.
+void
+instantiate_pending(Context& cxt)
+{
+  Template_state& st = cxt.template_state();
+  Template_state::Decl_queue deferred;
+  while (!st.pending.empty()) {
+    Function_decl& d = cast<Function_decl>(*st.pending.front());
+    st.pending.pop_front();
+    if (!instantiate_function(cxt, d))
+      deferred.push_back(&d);
+  }
+  st.pending.swap(deferred);
 }
 
 
@@ -305,6 +439,23 @@ transform_template_type(Context& cxt, Function_type& t, Decl_list& parms)
 }
 
 
+// Returns the transformed type of the function template `tmp`. This
+// is computed once for each template.
+Function_type&
+get_transformed_type(Context& cxt, Template_decl& tmp)
+{
+  Template_state& st = cxt.template_state();
+  auto iter = st.xforms.find(&tmp);
+  if (iter != st.xforms.end())
+    return *iter->second;
+
+  Function_decl& f = cast<Function_decl>(tmp.parameterized_declaration());
+  Function_type& t = transform_template_type(cxt, f.type(), tmp.parameters());
+  st.xforms.emplace(&tmp, &t);
+  return t;
+}
+
+
 // FIXME. Make derived classes Function_temp that saves me from
 // typing all this crap.
 inline Function_type&
@@ -348,14 +499,13 @@ transform_type_for_ordering(Type& t)
 // type of tmpl1 succeeds type of tmpl2. Adjustments are made depending
 // on cvontext.
 bool
-is_at_least_as_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
+compare_templates(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
 {
-  Function_decl& f1 = cast<Function_decl>(tmp1.parameterized_declaration());
   Function_decl& f2 = cast<Function_decl>(tmp2.parameterized_declaration());
 
-  // Transform the template type of tmp1 and use the
+  // Use the transformed template type of tmp1 and the
   // original function type of tmp2 for deduction.
-  Function_type& atype = transform_template_type(cxt, f1.type(), tmp1.parameters());
+  Function_type& atype = get_transformed_type(cxt, tmp1);
   Function_type& ptype = f2.type();
 
   // Get the types of each parameter/argument to be used in
@@ -378,6 +528,23 @@ is_at_least_as_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp
 }
 
 
+// Returns true if tmpl1 is at least as specialized as tmpl2. The
+// result is computed once for each pair of templates.
+bool
+is_at_least_as_specialized(Context& cxt, Template_decl& tmp1, Template_decl& tmp2)
+{
+  Template_state& st = cxt.template_state();
+  Template_state::Template_pair key {&tmp1, &tmp2};
+  auto iter = st.orders.find(key);
+  if (iter != st.orders.end())
+    return iter->second;
+
+  bool result = compare_templates(cxt, tmp1, tmp2);
+  st.orders.emplace(key, result);
+  return result;
+}
+
+
 
 // Determine whether tmp1 is more specialized than tmp2, or vice
 // versa.
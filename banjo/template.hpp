@@ -8,10 +8,56 @@
 #include "context.hpp"
 #include "ast.hpp"
 
+#include <boost/functional/hash.hpp>
+
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 
 namespace banjo
 {
 
+// The template state of a context.
+//
+// Partial ordering records the transformed type of each function
+// template and the results of comparing pairs of templates.
+//
+// Specializations whose definitions are needed are queued for
+// instantiation. Each is requested once.
+//
+// The instantiation stack records the specializations and concept
+// expansions in progress, innermost last. The set of active entries
+// detects recursive instantiation. Entries are compared by identity;
+// see Enter_instantiation.
+struct Template_state
+{
+  using Template_pair = std::pair<Template_decl const*, Template_decl const*>;
+  using Transform_map =
+    std::unordered_map<Template_decl const*, Function_type*>;
+  using Ordering_map = std::unordered_map<
+    Template_pair, bool, boost::hash<Template_pair>
+  >;
+  using Decl_queue = std::deque<Decl*>;
+  using Decl_set = std::unordered_set<Decl const*>;
+  using Instantiation_stack = std::vector<Term const*>;
+  using Instantiation_set = std::unordered_set<Term const*>;
+
+  Template_state()
+    : limit(1024)
+  { }
+
+  Transform_map       xforms;    // Transformed function template types
+  Ordering_map        orders;    // Partial ordering of function templates
+  Decl_queue          pending;   // Specializations awaiting instantiation
+  Decl_set            requested; // Specializations requested for instantiation
+  Instantiation_stack insts;     // Instantiations in progress
+  Instantiation_set   active;    // The set of instantiations in progress
+  std::size_t         limit;     // Maximum depth of instantiation
+};
+
+
 Type&     synthesize_template_argument(Context&, Type_parm&);
 Expr&     synthesize_template_argument(Context&, Value_parm&);
 Decl&     synthesize_template_argument(Context&, Template_parm&);
@@ -20,6 +66,9 @@ Term_list synthesize_template_arguments(Context&, Decl_list&);
 
 Decl& specialize_template(Context&, Template_decl&, Term_list&);
 
+void request_instantiation(Context&, Decl&);
+void instantiate_pending(Context&);
+
 
 // Encapsulates the results from a partial order.
 enum Partial_ordering
@@ -4,9 +4,13 @@
 #include "test.hpp"
 
 #include <banjo/normalization.hpp>
+#include <banjo/constraint.hpp>
 #include <banjo/subsumption.hpp>
+#include <banjo/satisfaction.hpp>
 
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 
 Concept_decl&
@@ -19,6 +23,17 @@ make_concept_1(Context& cxt)
   return c;
 }
 
+// Returns true if `c` is the predicate constraint `v`.
+bool
+is_literal(Cons& c, bool v)
+{
+  if (Predicate_cons* p = as<Predicate_cons>(&c))
+    if (Boolean_expr* b = as<Boolean_expr>(&p->expression()))
+      return b->value() == v;
+  return false;
+}
+
+
 void
 test_canonical(Context& cxt)
 {
@@ -37,11 +52,33 @@ test_canonical(Context& cxt)
   Expr& e1 = build.make_not(b, f);
   lingo_assert(&norm(e1) == &norm(e1));
 
-  // TODO: Check canonicalization of more constraints.
-
-  // Expr& e2 = build.make_and(b, t, e1);
-  // Expr& e3 = build.make_and(b, e2, c1);
-
+  // Conjunctions and disjunctions are simplified.
+  Expr& x = build.get_int(4000);
+  Expr& y = build.get_int(4001);
+  Expr& z = build.get_int(4002);
+  auto conj = [&](Expr& l, Expr& r) -> Expr& { return build.make_and(b, l, r); };
+  auto disj = [&](Expr& l, Expr& r) -> Expr& { return build.make_or(b, l, r); };
+  Cons& px = norm(x);
+
+  // Repeated operands are removed.
+  lingo_assert(&norm(disj(disj(disj(disj(x, x), x), x), x)) == &px);
+
+  // Absorption.
+  lingo_assert(&norm(conj(x, disj(y, x))) == &px);
+  lingo_assert(&norm(disj(conj(x, y), x)) == &px);
+
+  // Constant folding.
+  lingo_assert(&norm(conj(t, x)) == &px);
+  lingo_assert(&norm(disj(x, f)) == &px);
+  lingo_assert(is_literal(norm(conj(x, f)), false));
+  lingo_assert(is_literal(norm(disj(t, x)), true));
+
+  // Operands are flattened and ordered canonically.
+  Cons& c1 = norm(conj(conj(x, y), z));
+  Cons& c2 = norm(conj(z, conj(y, x)));
+  Cons& c3 = norm(conj(y, conj(conj(z, x), y)));
+  lingo_assert(&c1 == &c2 && &c1 == &c3);
+  lingo_assert(is<Predicate_cons>(&cast<Conjunction_cons>(c1).left()));
 }
 
 
@@ -80,6 +117,52 @@ test_subsume_1(Context& cxt)
 }
 
 
+// Expansions substitute into the normalized definition of a
+// concept, and are memoized.
+void
+test_expand(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& b = build.get_bool_type();
+  Concept_decl& c1 = make_concept_1(cxt);
+
+  // concept C2<typename T> = C1<T> && true;
+  Type_parm& p = build.make_type_parameter("T");
+  Type& t = build.get_typename_type(p);
+  Expr& e = build.make_and(b, build.make_check(c1, {&t}), build.get_true());
+  Concept_decl& c2 = build.make_concept("C2", {&p}, e);
+
+  Term_list a1 {&build.get_int_type()};
+  Term_list a2 {&build.get_int_type()};
+  Concept_cons& k1 = build.get_concept_constraint(c2, a1);
+  Concept_cons& k2 = build.get_concept_constraint(c2, a2);
+  lingo_assert(&k1 == &k2);
+
+  Cons& x = expand(cxt, k1);
+  lingo_assert(c2.cons);
+  lingo_assert(&expand(cxt, k1) == &x);
+  lingo_assert(cxt.constraint_state().expansions.size() == 1);
+
+  // The checks in the expansion are written in terms of the
+  // arguments. The predicate true is folded during normalization.
+  lingo_assert(&x == &build.get_concept_constraint(c1, a1));
+
+  // concept C3<typename T, typename U> = C1<T> || C1<U>;
+  //
+  // Expansions are simplified, so C3<int, int> is the single atom
+  // C1<int>.
+  Type_parm& p1 = build.make_type_parameter("T");
+  Type_parm& p2 = build.make_type_parameter("U");
+  Expr& e1 = build.make_check(c1, {&build.get_typename_type(p1)});
+  Expr& e2 = build.make_check(c1, {&build.get_typename_type(p2)});
+  Concept_decl& c3 = build.make_concept("C3", {&p1, &p2}, build.make_or(b, e1, e2));
+  Term_list a3 {&build.get_int_type(), &build.get_int_type()};
+  Cons& y = expand(cxt, build.get_concept_constraint(c3, a3));
+  lingo_assert(&y == &build.get_concept_constraint(c1, a1));
+}
+
+
 // This is GCC's bug 6756.
 void
 test_subsume_2(Context& cxt)
@@ -126,8 +209,432 @@ test_subsume_2(Context& cxt)
   Cons& con1 = normalize(cxt, e8);
   Cons& con2 = normalize(cxt, e9);
 
-  subsumes(cxt, con1, con2);
-  subsumes(cxt, con2, con1);
+  bool b1 = subsumes(cxt, con1, con2);
+  bool b2 = subsumes(cxt, con2, con1);
+
+  // Both results are memoized.
+  Subsumption_stats s1 = get_subsumption_stats(cxt);
+  lingo_assert(s1.size == 2 && s1.misses == 2 && s1.hits == 0);
+  lingo_assert(subsumes(cxt, con1, con2) == b1);
+  lingo_assert(subsumes(cxt, con2, con1) == b2);
+  Subsumption_stats s2 = get_subsumption_stats(cxt);
+  lingo_assert(s2.size == 2 && s2.misses == 2 && s2.hits == 2);
+
+  clear_subsumption_memo(cxt);
+  lingo_assert(get_subsumption_stats(cxt).size == 0);
+  lingo_assert(subsumes(cxt, con1, con2) == b1);
+}
+
+
+// Check subsumption of conjunctions and disjunctions of atoms.
+void
+test_subsume_3(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& b = build.get_bool_type();
+  Expr& p = build.get_int(10); // Not a valid constraint
+  Expr& q = build.get_int(11); // Not a valid constraint
+  Expr& r = build.get_int(12); // Not a valid constraint
+
+  Cons& p1 = normalize(cxt, p);
+  Cons& pq = normalize(cxt, build.make_and(b, p, q));
+  Cons& qrp = normalize(cxt, build.make_and(b, q, build.make_and(b, r, p)));
+  Cons& p_q = normalize(cxt, build.make_or(b, p, q));
+
+  lingo_assert(subsumes(cxt, pq, p1));
+  lingo_assert(!subsumes(cxt, p1, pq));
+  lingo_assert(subsumes(cxt, qrp, pq));
+  lingo_assert(!subsumes(cxt, pq, qrp));
+  lingo_assert(subsumes(cxt, p1, p_q));
+  lingo_assert(subsumes(cxt, pq, p_q));
+
+  // A disjunction of antecedents splits the proof into goals,
+  // each of which must be proven.
+  Expr& e1 = build.make_and(b, p, q);
+  Expr& e2 = build.make_and(b, p, r);
+  Cons& pq_pr = normalize(cxt, build.make_or(b, e1, e2));
+  lingo_assert(!subsumes(cxt, p_q, p1));
+  lingo_assert(subsumes(cxt, pq_pr, p1));
+  lingo_assert(!subsumes(cxt, pq_pr, pq));
+  lingo_assert(subsumes(cxt, p_q, p_q));
+
+  // Large conjunctions of atoms.
+  Expr* c1 = &build.get_int(2000);
+  Expr* c2 = &build.get_int(2000);
+  for (int i = 1; i < 256; ++i) {
+    c1 = &build.make_and(b, *c1, build.get_int(2000 + i));
+    if (i % 2 == 0)
+      c2 = &build.make_and(b, build.get_int(2000 + i), *c2);
+  }
+  Cons& x1 = normalize(cxt, *c1);
+  Cons& x2 = normalize(cxt, *c2);
+  lingo_assert(subsumes(cxt, x1, x2));
+  lingo_assert(!subsumes(cxt, x2, x1));
+}
+
+
+// Both subsumption engines give the same answers. Check each pair
+// of a set of constraints built from a few atoms and a concept.
+void
+test_engines(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& b = build.get_bool_type();
+  Expr& p = build.get_int(20); // Not a valid constraint
+  Expr& q = build.get_int(21); // Not a valid constraint
+  Expr& r = build.get_int(22); // Not a valid constraint
+
+  // concept C<typename T> = 20 || 21;
+  Type_parm& tp = build.make_type_parameter("T");
+  Concept_decl& c = build.make_concept("C", {&tp}, build.make_or(b, p, q));
+  Expr& k = build.make_check(c, {&build.get_int_type()});
+
+  std::vector<Expr*> es {
+    &p,
+    &k,
+    &build.make_and(b, p, q),
+    &build.make_or(b, p, q),
+    &build.make_and(b, build.make_or(b, p, r), build.make_or(b, q, r)),
+    &build.make_or(b, build.make_and(b, p, q), r),
+    &build.make_and(b, k, r),
+    &build.make_or(b, build.make_and(b, p, r), build.make_and(b, q, r)),
+  };
+  std::vector<Cons*> cs;
+  for (Expr* e : es)
+    cs.push_back(&normalize(cxt, *e));
+
+  for (Cons* c1 : cs) {
+    for (Cons* c2 : cs) {
+      clear_subsumption_memo(cxt);
+      cxt.subsumption_state().engine = sequent_engine;
+      bool r1 = subsumes(cxt, *c1, *c2);
+      clear_subsumption_memo(cxt);
+      cxt.subsumption_state().engine = bdd_engine;
+      bool r2 = subsumes(cxt, *c1, *c2);
+      lingo_assert(r1 == r2);
+    }
+  }
+
+  // A disjunction of many atoms is subsumed by each atom, and by
+  // a disjunction of conjunctions of those atoms.
+  int n = 48;
+  Expr* d1 = &build.get_int(1000);
+  Expr* d2 = &build.make_and(b, build.get_int(1000), r);
+  for (int i = 1; i < n; ++i) {
+    Expr& a = build.get_int(1000 + i);
+    d1 = &build.make_or(b, *d1, a);
+    d2 = &build.make_or(b, *d2, build.make_and(b, a, r));
+  }
+  Cons& x1 = normalize(cxt, *d1);
+  Cons& x2 = normalize(cxt, *d2);
+  lingo_assert(subsumes(cxt, x2, x1));
+  lingo_assert(!subsumes(cxt, x1, x2));
+  lingo_assert(subsumes(cxt, normalize(cxt, build.get_int(1017)), x1));
+
+  // The memo of diagram operations is bounded.
+  clear_subsumption_memo(cxt);
+  clear_decision_diagrams(cxt);
+  cxt.subsumption_state().bdd.limit = 16;
+  lingo_assert(subsumes(cxt, x2, x1));
+  lingo_assert(cxt.subsumption_state().bdd.cache_size() <= 16);
+  cxt.subsumption_state().bdd.limit = 1 << 20;
+
+  // Exceeding the node limit discards the diagrams, and later queries
+  // are still answered.
+  clear_subsumption_memo(cxt);
+  clear_decision_diagrams(cxt);
+  Subsumption_limits lim = cxt.subsumption_state().limits;
+  cxt.subsumption_state().limits.nodes = 32;
+  bool abandoned = false;
+  try {
+    subsumes(cxt, x2, x1);
+  } catch (Limitation_error&) {
+    abandoned = true;
+  }
+  lingo_assert(abandoned);
+  lingo_assert(cxt.subsumption_state().bdd.size() == 2);
+  lingo_assert(subsumes(cxt, *cs[0], *cs[3]));
+  lingo_assert(!subsumes(cxt, *cs[3], *cs[0]));
+  cxt.subsumption_state().limits = lim;
+
+  cxt.subsumption_state().engine = sequent_engine;
+  clear_subsumption_memo(cxt);
+}
+
+
+// Generate a corpus of concept hierarchies, and count the number of
+// expansion steps the sequent engine takes to decide subsumption
+// queries against them.
+void
+test_heuristics(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type& b = build.get_bool_type();
+  int next = 3000;
+  auto atom = [&]() -> Expr& { return build.get_int(next++); };
+
+  // Returns a concept whose definition combines checks of the
+  // concepts `cs` with the atoms `as`.
+  auto define = [&](std::vector<Concept_decl*> const& cs,
+                    std::vector<Expr*> const& as,
+                    bool disj) -> Concept_decl&
+  {
+    Type_parm& p = build.make_type_parameter("T");
+    Type& t = build.get_typename_type(p);
+    Expr* e = nullptr;
+    auto add = [&](Expr& x) {
+      if (!e)
+        e = &x;
+      else if (disj)
+        e = &build.make_or(b, *e, x);
+      else
+        e = &build.make_and(b, *e, x);
+    };
+    for (Concept_decl* c : cs)
+      add(build.make_check(*c, {&t}));
+    for (Expr* a : as)
+      add(*a);
+    return build.make_concept("K", {&p}, *e);
+  };
+
+  auto check = [&](Concept_decl& c) -> Cons& {
+    return normalize(cxt, build.make_check(c, {&build.get_int_type()}));
+  };
+
+  clear_subsumption_memo(cxt);
+  int queries = 0;
+  Cons* last = nullptr;
+  Cons* deepest = nullptr;
+  for (int d = 4; d <= 16; d *= 2) {
+    // A heavy chain of concepts, rooted in a disjunction:
+    //
+    //    H0 = x || y
+    //    Hi = H(i-1) && ai
+    Expr& a0 = atom();
+    Concept_decl* h = &define({}, {&a0, &atom()}, true);
+    Expr* deep = nullptr;
+    for (int i = 1; i < d; ++i) {
+      Expr& a = atom();
+      if (i == 1)
+        deep = &a;
+      h = &define({h}, {&a}, false);
+    }
+
+    // A light concept, and a disjunctive one.
+    Expr& t = atom();
+    Concept_decl& l = define({}, {&t}, false);
+    Concept_decl& u = define({}, {&atom(), &atom()}, true);
+
+    Concept_decl& r1 = define({h, &l}, {}, false);
+    Concept_decl& r2 = define({&l, h}, {}, false);
+    Concept_decl& r3 = define({&u, h, &l}, {}, false);
+    Concept_decl& r4 = define({h, &u}, {}, false);
+
+    // Properties describe only the definition of each concept.
+    Constraint_props const& hp = get_concept_properties(cxt, *h);
+    Constraint_props const& up = get_concept_properties(cxt, u);
+    Constraint_props const& rp = get_concept_properties(cxt, r3);
+    lingo_assert(hp.atoms == 1 && hp.checks == 1 && !hp.is_disjunctive());
+    lingo_assert(up.atoms == 2 && up.depth == 1 && up.is_disjunctive());
+    lingo_assert(rp.atoms == 0 && rp.checks == 3);
+
+    lingo_assert(subsumes(cxt, check(r1), normalize(cxt, t)));
+    lingo_assert(subsumes(cxt, check(r2), normalize(cxt, *deep)));
+    lingo_assert(subsumes(cxt, check(r3), normalize(cxt, t)));
+    lingo_assert(subsumes(cxt, check(r4), check(u)));
+    lingo_assert(!subsumes(cxt, check(r4), normalize(cxt, t)));
+    queries += 5;
+    last = &check(r1);
+    deepest = &normalize(cxt, *deep);
+  }
+
+  std::cout << "expansion steps: " << get_subsumption_stats(cxt).steps
+            << " for " << queries << " queries\n";
+
+  // Disjunctions were split, and concepts are listed by the number
+  // of times each was expanded.
+  Subsumption_stats s = get_subsumption_stats(cxt);
+  lingo_assert(s.branches != 0 && s.peak >= 2);
+  lingo_assert(!s.expansions.empty());
+  for (std::size_t i = 1; i < s.expansions.size(); ++i)
+    lingo_assert(s.expansions[i - 1].second >= s.expansions[i].second);
+  std::stringstream ss;
+  dump_subsumption_stats(ss, cxt);
+  lingo_assert(ss.str().find("expansions") != std::string::npos);
+
+  // A proof taking more steps than allowed is abandoned.
+  Subsumption_limits lim = cxt.subsumption_state().limits;
+  cxt.subsumption_state().limits.steps = 4;
+  bool abandoned = false;
+  try {
+    subsumes(cxt, *last, *deepest);
+  } catch (Limitation_error&) {
+    abandoned = true;
+  }
+  cxt.subsumption_state().limits = lim;
+  lingo_assert(abandoned);
+  lingo_assert(subsumes(cxt, *last, *deepest));
+}
+
+
+// Check that the satisfaction of concept checks and predicates is
+// memoized, and that results depending on an incomplete class are
+// discarded when the class is defined.
+void
+test_satisfaction(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+
+  // K<T> = true
+  Type_parm& p = build.make_type_parameter("T");
+  Concept_decl& k = build.make_concept("K", {&p}, build.get_true());
+
+  // V<T> = true
+  Type_parm& v = build.make_type_parameter("T");
+  Concept_decl& w = build.make_concept("V", {&v}, build.get_true());
+
+  // R<U> = K<U> && V<U>
+  Type_parm& q = build.make_type_parameter("U");
+  Type& u = build.get_typename_type(q);
+  Expr& e = build.make_and(b, build.make_check(k, {&u}),
+                              build.make_check(w, {&u}));
+  Concept_decl& r = build.make_concept("R", {&q}, e);
+
+  Class_decl& x = build.make_class("X");
+  Type& xp = build.get_pointer_type(build.get_class_type(x));
+  Cons& c1 = normalize(cxt, build.make_check(r, {&build.get_int_type()}));
+  Cons& c2 = normalize(cxt, build.make_check(r, {&xp}));
+
+  // Satisfying R<int> memoizes R<int>, K<int>, V<int>, and true.
+  // The predicate is shared by both concepts, and evaluated once.
+  clear_satisfaction_memo(cxt);
+  lingo_assert(is_satisfied(cxt, c1));
+  Satisfaction_stats s = get_satisfaction_stats(cxt);
+  lingo_assert(s.size == 4 && s.hits == 1 && s.misses == 4);
+  lingo_assert(is_satisfied(cxt, c1));
+  lingo_assert(get_satisfaction_stats(cxt).hits == 2);
+
+  // Only the checks are new for R<X*>.
+  lingo_assert(is_satisfied(cxt, c2));
+  s = get_satisfaction_stats(cxt);
+  lingo_assert(s.size == 7 && s.hits == 4 && s.misses == 7);
+
+  // Defining X discards only the results for checks naming X.
+  x.def = &build.make_class_definition(Decl_list());
+  invalidate_satisfaction(cxt, x);
+  lingo_assert(get_satisfaction_stats(cxt).size == 4);
+  lingo_assert(is_satisfied(cxt, c2));
+  lingo_assert(get_satisfaction_stats(cxt).size == 7);
+
+  // The same is true of predicates naming an incomplete class, even
+  // when they are not part of a check.
+  Class_decl& y = build.make_class("Y");
+  Type& yp = build.get_pointer_type(build.get_class_type(y));
+  Cons& c3 = normalize(cxt, build.make_not(b, build.get_zero(yp)));
+  lingo_assert(is_satisfied(cxt, c3));
+  lingo_assert(get_satisfaction_stats(cxt).size == 8);
+  y.def = &build.make_class_definition(Decl_list());
+  invalidate_satisfaction(cxt, y);
+  lingo_assert(get_satisfaction_stats(cxt).size == 7);
+
+  // A check over int whose definition checks K<Z*> also depends on Z,
+  // whether K<Z*> is satisfied in its expansion or found in the memo.
+  //
+  // S1<T> = K<Z*>
+  // S2<T> = K<Z*>
+  Class_decl& z = build.make_class("Z");
+  Type& zp = build.get_pointer_type(build.get_class_type(z));
+  Type_parm& t1 = build.make_type_parameter("T");
+  Concept_decl& s1 = build.make_concept("S1", {&t1}, build.make_check(k, {&zp}));
+  Type_parm& t2 = build.make_type_parameter("T");
+  Concept_decl& s2 = build.make_concept("S2", {&t2}, build.make_check(k, {&zp}));
+  Cons& c4 = normalize(cxt, build.make_check(s1, {&build.get_int_type()}));
+  Cons& c5 = normalize(cxt, build.make_check(s2, {&build.get_int_type()}));
+  lingo_assert(is_satisfied(cxt, c4));
+  lingo_assert(is_satisfied(cxt, c5));
+  Satisfaction_state& st = cxt.satisfaction_state();
+  lingo_assert(st.memo.count(&c4) && st.memo.count(&c5));
+  z.def = &build.make_class_definition(Decl_list());
+  invalidate_satisfaction(cxt, z);
+  lingo_assert(!st.memo.count(&c4) && !st.memo.count(&c5));
+  lingo_assert(get_satisfaction_stats(cxt).size == 7);
+}
+
+
+// Check that the operands of a conjunction are satisfied in order of
+// estimated cost and likelihood of failure.
+void
+test_plan(Context& cxt)
+{
+  Builder build(cxt);
+  Type& b = build.get_bool_type();
+  Expr& yes = build.make_not(b, build.get_false());
+  Expr& no = build.make_not(b, build.get_true());
+
+  // Returns a concept whose definition is the conjunction of the given
+  // checks and predicates.
+  auto define = [&](std::vector<Concept_decl*> const& cs,
+                    std::vector<Expr*> const& ps) -> Concept_decl&
+  {
+    Type_parm& p = build.make_type_parameter("T");
+    Type& t = build.get_typename_type(p);
+    Expr* e = nullptr;
+    auto add = [&](Expr& x) { e = e ? &build.make_and(b, *e, x) : &x; };
+    for (Concept_decl* c : cs)
+      add(build.make_check(*c, {&t}));
+    for (Expr* x : ps)
+      add(*x);
+    return build.make_concept("P", {&p}, *e);
+  };
+
+  // A deep chain of concepts that are always satisfied.
+  Concept_decl* d = &define({}, {&yes});
+  for (int i = 0; i < 8; ++i)
+    d = &define({d}, {&yes});
+
+  // The failing predicate is evaluated before the chain is expanded.
+  Concept_decl& r1 = define({d}, {&no});
+  Type& z = build.get_int_type();
+  Cons& c1 = normalize(cxt, build.make_check(r1, {&z}));
+  Term_list a1 {&z};
+  Satisfaction_state& st = cxt.satisfaction_state();
+  lingo_assert(!is_satisfied(cxt, c1));
+  lingo_assert(!st.memo.count(&build.get_concept_constraint(*d, a1)));
+
+  // A is cheaper than F, but F usually fails. Once F has failed, it
+  // is checked first, and A is no longer checked.
+  Concept_decl& a = define({}, {&yes});
+  Concept_decl& f = define({}, {&yes, &no});
+  Concept_decl& r2 = define({&a, &f}, {});
+  Type* t = &z;
+  for (int i = 0; i < 4; ++i) {
+    t = &build.get_pointer_type(*t);
+    Cons& c2 = normalize(cxt, build.make_check(r2, {t}));
+    lingo_assert(!is_satisfied(cxt, c2));
+    Term_list a2 {t};
+    bool checked = st.memo.count(&build.get_concept_constraint(a, a2));
+    lingo_assert(checked == (i == 0));
+  }
+
+  // The same holds for the atoms of a concept. Each check evaluates
+  // new instances of them, but these share the history of the atom.
+  //
+  // Q<N> = !!N && !N
+  Value_parm& n = build.make_value_parm("N", z);
+  Expr& en = build.make_reference(n);
+  Expr& e1 = build.make_not(b, build.make_not(b, en));
+  Expr& e2 = build.make_not(b, en);
+  Concept_decl& q = build.make_concept("Q", {&n}, build.make_and(b, e1, e2));
+  for (int i = 1; i <= 4; ++i) {
+    std::size_t m = st.misses;
+    Cons& c3 = normalize(cxt, build.make_check(q, {&build.get_int(i)}));
+    lingo_assert(!is_satisfied(cxt, c3));
+    lingo_assert(st.misses - m == (i == 1 ? 3 : 2));
+  }
 }
 
 
@@ -136,6 +643,12 @@ main(int argc, char* argv[])
 {
   Context cxt;
   test_canonical(cxt);
+  test_expand(cxt);
   // test_subsume_1(cxt);
   test_subsume_2(cxt);
+  test_subsume_3(cxt);
+  test_engines(cxt);
+  test_heuristics(cxt);
+  test_satisfaction(cxt);
+  test_plan(cxt);
 }
@@ -47,6 +47,51 @@ test_deduce_from_type(Context& cxt)
 }
 
 
+// Deduce from function types, and check that mismatched shapes
+// are rejected.
+void
+test_deduce_function(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type_parm& t = build.make_type_parameter("T");
+  Type_parm& u = build.make_type_parameter("U");
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Type& tt = build.get_typename_type(t);
+  Type& ut = build.get_typename_type(u);
+  Decl_list parms {&t, &u};
+  build.make_template(parms, build.make_variable("v", z));
+
+  // T(T*, U&) vs int(int*, bool&)
+  Type_list ps {&build.get_pointer_type(tt), &build.get_reference_type(ut)};
+  Type& p = build.get_function_type(ps, tt);
+  Type_list as {&build.get_pointer_type(z), &build.get_reference_type(b)};
+  Type& a = build.get_function_type(as, z);
+  Substitution s1(parms);
+  lingo_assert(deduce_from_type(p, a, s1));
+  lingo_assert(s1.get_mapping(t) == &z);
+  lingo_assert(s1.get_mapping(u) == &b);
+
+  // T(T*, U&) vs bool(int*, bool&): inconsistent deductions for T.
+  Type& a2 = build.get_function_type(as, b);
+  Substitution s2(parms);
+  lingo_assert(!deduce_from_type(p, a2, s2));
+
+  // T** vs int*: rejected by shape.
+  Type& pp = build.get_pointer_type(build.get_pointer_type(tt));
+  Type& ap = build.get_pointer_type(z);
+  lingo_assert(!may_deduce(get_shape(pp), get_shape(ap)));
+  Substitution s3(parms);
+  lingo_assert(!deduce_from_type(pp, ap, s3));
+  lingo_assert(!s3.get_mapping(t));
+
+  // int* vs int*: non-dependent types are compared.
+  Type& ip = build.get_pointer_type(z);
+  lingo_assert(deduce_from_type(ip, ap, s3));
+}
+
+
 
 
 int
@@ -54,4 +99,5 @@ main(int argc, char* argv[])
 {
   Context cxt;
   test_deduce_from_type(cxt);
+  test_deduce_function(cxt);
 }
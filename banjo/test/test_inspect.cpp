@@ -80,8 +80,8 @@ main(int argc, char* argv[])
 //      'resolve' postscript-expression ';'
 //      'instantiate' template-id ';'
 //      'satisfy' check-expr ';'
-//      'order' '.' 'template' template-id template-id ';'
-//      'order' '.' 'concept' concept-id concept-id ';'
+//      'order' '.' 'template' template-name template-name ';'
+//      'order' '.' 'concept' concept-name concept-name ';'
 //      'inspect.expr' expression ';'
 void
 directive_seq(Parser& p)
@@ -216,18 +216,21 @@ order_concept_directive(Parser& p)
 }
 
 
+// Determine if the first function template is more specialized
+// than the second.
+//
 // FIXME: How do I compare two templates with the same name?
-// Just give them different names?
+// For now, just give them different names.
 void
 order_template_directive(Parser& p)
 {
-  // p.require(template_tok);
-  // Name& n1 = p.template_id();
-  // Name& n2 = p.template_id();
+  p.require(template_tok);
+  Template_decl& t1 = cast<Template_decl>(p.template_name());
+  Template_decl& t2 = cast<Template_decl>(p.template_name());
+  p.match(semicolon_tok);
 
-  // TODO: Resolve the function templates referred to by these
-  // ids and determine which is more specialized.
-  lingo_unimplemented();
+  bool result = is_more_specialized(p.cxt, t1, t2);
+  std::cout << std::boolalpha << result << '\n';
 }
 
 
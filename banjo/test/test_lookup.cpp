@@ -0,0 +1,276 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/lookup.hpp>
+#include <banjo/declaration.hpp>
+#include <banjo/scope.hpp>
+#include <banjo/inheritance.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// Count the number of allocations so that we can verify that
+// lookup does not allocate.
+static std::size_t allocs = 0;
+
+
+void*
+operator new(std::size_t n)
+{
+  ++allocs;
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+
+void
+operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+
+// Returns the number of microseconds elapsed since `t`.
+long
+elapsed(Clock::time_point t)
+{
+  auto d = Clock::now() - t;
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+
+// Declare `n` functions in a single namespace and look each of them
+// up by qualified name.
+void
+test_wide_namespace(Context& cxt, int n)
+{
+  Builder build(cxt);
+
+  Namespace_decl& ns = build.make_namespace("N");
+  ns.context(cxt.global_namespace());
+
+  std::vector<Simple_id*> ids;
+  for (int i = 0; i < n; ++i) {
+    Simple_id& id = build.get_id("g" + std::to_string(i));
+    Function_decl& f = build.make_function(id, {}, build.get_void_type());
+    f.context(ns);
+    declare(cxt, *ns.scope(), f);
+    ids.push_back(&id);
+  }
+
+  std::size_t a = allocs;
+  auto start = Clock::now();
+  for (int i = 0; i < n; ++i) {
+    Overload_view ds = qualified_lookup(ns, *ids[i]);
+    lingo_assert(ds.size() == 1);
+    lingo_assert(&ds.front().declared_name() == ids[i]);
+  }
+  long t = elapsed(start);
+
+  // Lookup returns a view of the overload set; nothing is copied.
+  lingo_assert(allocs == a);
+
+  // Qualified lookup does not search enclosing scopes.
+  bool found = true;
+  try {
+    qualified_lookup(ns, build.get_id("missing"));
+  } catch (Lookup_error&) {
+    found = false;
+  }
+  lingo_assert(!found);
+
+  std::cout << "qualified lookup: " << n << " members, "
+            << t << "us\n";
+}
+
+
+// Declare `n` namespaces, each with a class `Ci` and a function
+// `f(Ci)`, and perform argument-dependent lookup for calls to `f`
+// with `m` arguments drawn from those classes.
+void
+test_adl(Context& cxt, int n, int m, int reps)
+{
+  Builder build(cxt);
+
+  Simple_id& f = build.get_id("f");
+
+  std::vector<Type*> types;
+  for (int i = 0; i < n; ++i) {
+    std::string s = std::to_string(i);
+    Namespace_decl& ns = build.make_namespace(build.get_id("M" + s));
+    ns.context(cxt.global_namespace());
+
+    Class_decl& c = build.make_class(build.get_id("C" + s));
+    c.context(ns);
+    declare(cxt, *ns.scope(), c);
+    Type& t = build.get_class_type(c);
+    types.push_back(&t);
+
+    Decl_list ps {&build.make_object_parm("x", t)};
+    Function_decl& fn = build.make_function(f, ps, build.get_void_type());
+    fn.context(ns);
+    declare(cxt, *ns.scope(), fn);
+  }
+
+  Expr_list args;
+  for (int i = 0; i < m; ++i) {
+    Simple_id& id = build.get_id("v" + std::to_string(i));
+    Variable_decl& v = build.make_variable(id, *types[i % n]);
+    args.push_back(build.make_reference(v));
+  }
+
+  auto start = Clock::now();
+  for (int i = 0; i < reps; ++i) {
+    Decl_list ds = argument_dependent_lookup(cxt, f, args);
+    lingo_assert(ds.size() == std::size_t(std::min(n, m)));
+  }
+  long t = elapsed(start);
+
+  std::cout << "argument-dependent lookup: " << n << " namespaces, "
+            << m << " arguments, " << reps << " calls, "
+            << t << "us\n";
+}
+
+
+// Define the class `c` with the given bases and a single member
+// variable named `m`.
+void
+define_class(Builder& build, Class_decl& c, Type_list const& bs, char const* m)
+{
+  Variable_decl& v = build.make_variable(m, build.get_int_type());
+  v.context(c);
+  c.scope()->bind(v);
+  c.def = &build.make_class_definition(bs, {&v});
+}
+
+
+// Test member lookup and base class queries in class hierarchies.
+// This builds a chain of `n` classes where each class derives from
+// the previous one.
+void
+test_class_hierarchy(Context& cxt, int n)
+{
+  Builder build(cxt);
+
+  // Diamond inheritance:
+  //
+  //    struct A { int a; };
+  //    struct B : A { int b; };
+  //    struct C : A { int c; };
+  //    struct D : B, C { int d; };
+  Class_decl& a = build.make_class("A");
+  Class_decl& b = build.make_class("B");
+  Class_decl& c = build.make_class("C");
+  Class_decl& d = build.make_class("D");
+  Type& at = build.get_class_type(a);
+  Type& bt = build.get_class_type(b);
+  Type& ct = build.get_class_type(c);
+  Type& dt = build.get_class_type(d);
+
+  // Classes are numbered by their context.
+  lingo_assert(d.number() == a.number() + 3);
+  lingo_assert(cxt.classes == d.number() + 1);
+
+  // While D is incomplete, it has no bases.
+  lingo_assert(!is_base_class(at, dt));
+
+  define_class(build, a, {}, "a");
+  define_class(build, b, {&at}, "x");
+  define_class(build, c, {&at}, "x");
+  define_class(build, d, {&bt, &ct}, "d");
+
+  lingo_assert(is_base_class(at, bt));
+  lingo_assert(is_base_class(at, dt));
+  lingo_assert(is_base_class(ct, dt));
+  lingo_assert(is_derived_class(dt, at));
+  lingo_assert(!is_base_class(dt, at));
+  lingo_assert(!is_base_class(bt, ct));
+  lingo_assert(!is_base_class(at, at));
+  lingo_assert(base_classes(d).size() == 3);
+
+  // A is inherited along two paths, but found once.
+  Overload_view ds = qualified_lookup(d, build.get_id("a"));
+  lingo_assert(ds.size() == 1);
+  lingo_assert(ds.front().context() == &a);
+
+  // x is declared in both B and C.
+  bool ambiguous = false;
+  try {
+    qualified_lookup(d, build.get_id("x"));
+  } catch (Lookup_error&) {
+    ambiguous = true;
+  }
+  lingo_assert(ambiguous);
+
+  // A declaration in a base hides those in its own bases, even when
+  // those are also direct bases:
+  //
+  //    struct X { int y; };
+  //    struct Y { int y; };
+  //    struct Z : X, Y { int y; };
+  //    struct W : X, Y, Z { int w; };
+  Class_decl& x = build.make_class("X");
+  Class_decl& y = build.make_class("Y");
+  Class_decl& z = build.make_class("Z");
+  Class_decl& w = build.make_class("W");
+  Type& xt = build.get_class_type(x);
+  Type& yt = build.get_class_type(y);
+  Type& zt = build.get_class_type(z);
+  define_class(build, x, {}, "y");
+  define_class(build, y, {}, "y");
+  define_class(build, z, {&xt, &yt}, "y");
+  define_class(build, w, {&xt, &yt, &zt}, "w");
+  ds = qualified_lookup(w, build.get_id("y"));
+  lingo_assert(ds.front().context() == &z);
+
+  // A deep chain of classes.
+  std::vector<Class_decl*> cs;
+  for (int i = 0; i < n; ++i) {
+    Class_decl& k = build.make_class(build.get_id("K" + std::to_string(i)));
+    Type_list bs;
+    if (i != 0)
+      bs.push_back(build.get_class_type(*cs.back()));
+    define_class(build, k, bs, i == 0 ? "root" : "m");
+    cs.push_back(&k);
+  }
+
+  auto start = Clock::now();
+  Class_decl& leaf = *cs.back();
+  for (int i = 0; i < n - 1; ++i)
+    lingo_assert(is_base_class(*cs[i], leaf));
+  long t1 = elapsed(start);
+
+  start = Clock::now();
+  Simple_id& root = build.get_id("root");
+  for (int i = 0; i < n; ++i) {
+    Overload_view ds = qualified_lookup(*cs[i], root);
+    lingo_assert(ds.front().context() == cs[0]);
+  }
+  long t2 = elapsed(start);
+
+  std::cout << "base class queries: " << n << " classes, "
+            << t1 << "us\n";
+  std::cout << "member lookup: " << n << " classes, "
+            << t2 << "us\n";
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  Context cxt;
+
+  test_wide_namespace(cxt, 16384);
+  test_adl(cxt, 64, 256, 1000);
+  test_class_hierarchy(cxt, 1000);
+}
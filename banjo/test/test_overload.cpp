@@ -0,0 +1,299 @@
+// Copyright (c) 2015-2016 Andrew Sutton
+// All rights reserved
+
+#include "test.hpp"
+
+#include <banjo/lookup.hpp>
+#include <banjo/declaration.hpp>
+#include <banjo/scope.hpp>
+#include <banjo/call.hpp>
+#include <banjo/template.hpp>
+#include <banjo/conversion.hpp>
+#include <banjo/equivalence.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+using Clock = std::chrono::steady_clock;
+
+
+// Returns the number of microseconds elapsed since `t`.
+long
+elapsed(Clock::time_point t)
+{
+  auto d = Clock::now() - t;
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+
+// Declare the overloads of `f` in the global namespace. For each
+// arity from 1 to `n`, the first parameter is either `int` or `int*`
+// and, when there are two or more parameters, the last is either
+// `int` or `int*`. All other parameters are `int`. This yields
+// 4n - 2 overloads.
+Overload_set&
+declare_overloads(Context& cxt, Simple_id& f, int n)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& p = build.get_pointer_type(z);
+  Scope& s = *cxt.global_namespace().scope();
+
+  for (int a = 1; a <= n; ++a) {
+    for (Type* first : {&z, &p}) {
+      for (Type* last : {&z, &p}) {
+        if (a == 1 && last != first)
+          continue;
+        Decl_list ps;
+        for (int i = 0; i < a; ++i) {
+          Type& t = i == 0 ? *first : i == a - 1 ? *last : z;
+          ps.push_back(build.make_object_parm("x", t));
+        }
+        declare(cxt, s, build.make_function(f, ps, build.get_void_type()));
+      }
+    }
+  }
+  return *s.lookup(f);
+}
+
+
+// Build a list of `n` arguments, all of type int except for
+// the first, when `ptr` is true.
+Expr_list
+make_arguments(Context& cxt, int n, bool ptr)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& p = build.get_pointer_type(z);
+  Expr_list args;
+  for (int i = 0; i < n; ++i) {
+    Type& t = i == 0 && ptr ? p : z;
+    args.push_back(build.make_reference(build.make_variable("v", t)));
+  }
+  return args;
+}
+
+
+// Resolve calls by trying every function in the overload set.
+Function_decl*
+resolve_naive(Context& cxt, Overload_set& ovl, Expr_list& args)
+{
+  Function_decl* result = nullptr;
+  for (Decl& d : Overload_view(ovl)) {
+    Function_decl& f = cast<Function_decl>(d);
+    try {
+      build_function_call(cxt, f, args);
+      lingo_assert(!result);
+      result = &f;
+    } catch (std::runtime_error&) {
+    }
+  }
+  return result;
+}
+
+
+// Declare 2^n overloads of `h` with n parameters, each of which
+// is either `int` or `bool`. Calls with `int` and `bool` arguments
+// are viable for all overloads, but each call has a unique best
+// viable function.
+void
+test_ranking(Context& cxt, int n, int reps)
+{
+  Builder build(cxt);
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Scope& s = *cxt.global_namespace().scope();
+  Simple_id& h = build.get_id("h");
+
+  for (int k = 0; k < (1 << n); ++k) {
+    Decl_list ps;
+    for (int i = 0; i < n; ++i) {
+      Type& t = (k & (1 << i)) ? b : z;
+      ps.push_back(build.make_object_parm("x", t));
+    }
+    declare(cxt, s, build.make_function(h, ps, build.get_void_type()));
+  }
+  Overload_set& ovl = *s.lookup(h);
+
+  // Build a call for each combination of argument types, and check
+  // that the function with the same parameter types is selected.
+  std::vector<Expr_list> calls;
+  for (int k = 0; k < (1 << n); ++k) {
+    Expr_list args;
+    for (int i = 0; i < n; ++i) {
+      Type& t = (k & (1 << i)) ? b : z;
+      args.push_back(build.make_reference(build.make_variable("v", t)));
+    }
+    calls.push_back(args);
+  }
+
+  auto start = Clock::now();
+  std::size_t convs = 0;
+  for (int r = 0; r < reps; ++r) {
+    for (Expr_list& args : calls) {
+      Call_expr& c = cast<Call_expr>(build_function_call(cxt, ovl, args));
+      Reference_expr& f = cast<Reference_expr>(c.function());
+      Function_type& t = cast<Function_decl>(f.declaration()).type();
+      auto ai = args.begin();
+      for (Type& p : t.parameter_types()) {
+        Type& a = cast<Reference_type>(ai->type()).type();
+        lingo_assert(is_equivalent(p, a));
+        ++ai;
+      }
+    }
+
+    // Conversions are only computed during the first round.
+    if (r == 0)
+      convs = cxt.conversion_state().memo.size();
+    lingo_assert(cxt.conversion_state().memo.size() == convs);
+  }
+  long t = elapsed(start);
+
+  std::cout << "best viable function: " << ovl.size() << " overloads, "
+            << reps * calls.size() << " calls, "
+            << cxt.conversion_state().memo.size() << " conversions, "
+            << t << "us\n";
+}
+
+
+// Check that a call to an unqualified name also considers the
+// functions found by argument-dependent lookup, and that a call to
+// a qualified name considers only the members of its scope.
+//
+//    void k(int);
+//    namespace N {
+//      struct C;
+//      void k(C*);
+//    }
+void
+test_call_lookup(Context& cxt)
+{
+  Builder build(cxt);
+  Enter_scope scope(cxt, cxt.global_namespace());
+  Type& z = build.get_int_type();
+  Simple_id& k = build.get_id("k");
+
+  Function_decl& k1 = build.make_function(k, {&build.make_object_parm("x", z)},
+                                          build.get_void_type());
+  declare(cxt, *cxt.global_namespace().scope(), k1);
+
+  Namespace_decl& ns = build.make_namespace("N");
+  ns.context(cxt.global_namespace());
+  Class_decl& c = build.make_class("C");
+  c.context(ns);
+  declare(cxt, *ns.scope(), c);
+  Type& cp = build.get_pointer_type(build.get_class_type(c));
+  Function_decl& k2 = build.make_function(k, {&build.make_object_parm("x", cp)},
+                                          build.get_void_type());
+  k2.context(ns);
+  declare(cxt, *ns.scope(), k2);
+
+  // k(p) calls N::k.
+  Expr_list a1 {&build.make_reference(build.make_variable("p", cp))};
+  Call_expr& c1 = cast<Call_expr>(build_function_call(cxt, k, a1));
+  lingo_assert(&cast<Reference_expr>(c1.function()).declaration() == &k2);
+
+  // k(0) calls ::k.
+  Expr_list a2 {&build.make_reference(build.make_variable("v", z))};
+  Call_expr& c2 = cast<Call_expr>(build_function_call(cxt, k, a2));
+  lingo_assert(&cast<Reference_expr>(c2.function()).declaration() == &k1);
+
+  // N::k(p) calls N::k.
+  Name& q = build.get_qualified_id(ns, k);
+  Call_expr& c3 = cast<Call_expr>(build_function_call(cxt, q, a1));
+  lingo_assert(&cast<Reference_expr>(c3.function()).declaration() == &k2);
+}
+
+
+// Check that function templates are candidates for the arguments
+// deduced from the call, and that functions that are not templates
+// are preferred.
+//
+//    template<typename T> void t(T);
+//    void t(int);
+void
+test_template_call(Context& cxt)
+{
+  Builder build(cxt);
+  Enter_scope scope(cxt, cxt.global_namespace());
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Simple_id& t = build.get_id("t");
+
+  Type_parm& tp = build.make_type_parameter("T");
+  Type& tt = build.get_typename_type(tp);
+  Function_decl& f = build.make_function(t, {&build.make_object_parm("x", tt)},
+                                         build.get_void_type());
+  Template_decl& tmp = build.make_template({&tp}, f);
+  declare(cxt, *cxt.global_namespace().scope(), tmp);
+  Function_decl& g = build.make_function(t, {&build.make_object_parm("x", z)},
+                                         build.get_void_type());
+  declare(cxt, *cxt.global_namespace().scope(), g);
+
+  // t(v) calls t<bool> and requests its definition.
+  Expr_list a1 {&build.make_reference(build.make_variable("v", b))};
+  Call_expr& c1 = cast<Call_expr>(build_function_call(cxt, t, a1));
+  Term_list ta {&b};
+  Decl& s = specialize_template(cxt, tmp, ta);
+  lingo_assert(&cast<Reference_expr>(c1.function()).declaration() == &s);
+  lingo_assert(cxt.template_state().requested.count(&s));
+
+  // t(i) calls t(int).
+  Expr_list a2 {&build.make_reference(build.make_variable("i", z))};
+  Call_expr& c2 = cast<Call_expr>(build_function_call(cxt, t, a2));
+  lingo_assert(&cast<Reference_expr>(c2.function()).declaration() == &g);
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  Context cxt;
+  Builder build(cxt);
+
+  int n = 16;
+  int reps = 200;
+  Simple_id& f = build.get_id("f");
+  Overload_set& ovl = declare_overloads(cxt, f, n);
+  lingo_assert(ovl.size() == std::size_t(4 * n - 2));
+
+  // Redeclaring an overload does not add it to the set.
+  Decl_list ps {&build.make_object_parm("x", build.get_int_type())};
+  Function_decl& g = build.make_function(f, ps, build.get_void_type());
+  declare(cxt, *cxt.global_namespace().scope(), g);
+  lingo_assert(ovl.size() == std::size_t(4 * n - 2));
+
+  Expr_list a1 = make_arguments(cxt, n, false);
+  Expr_list a2 = make_arguments(cxt, n / 2, true);
+
+  // Only functions with the right arity and first parameter
+  // category are candidates.
+  lingo_assert(ovl.candidates(a1).size() == 2);
+  lingo_assert(ovl.candidates(a2).size() == 2);
+
+  auto start = Clock::now();
+  for (int i = 0; i < reps; ++i) {
+    Call_expr& c1 = cast<Call_expr>(build_function_call(cxt, ovl, a1));
+    Call_expr& c2 = cast<Call_expr>(build_function_call(cxt, ovl, a2));
+    lingo_assert(c1.arguments().size() == std::size_t(n));
+    lingo_assert(c2.arguments().size() == std::size_t(n / 2));
+  }
+  long t1 = elapsed(start);
+
+  start = Clock::now();
+  for (int i = 0; i < reps; ++i) {
+    lingo_assert(resolve_naive(cxt, ovl, a1));
+    lingo_assert(resolve_naive(cxt, ovl, a2));
+  }
+  long t2 = elapsed(start);
+
+  std::cout << "overload resolution: " << ovl.size() << " overloads, "
+            << 2 * reps << " calls, indexed " << t1 << "us, "
+            << "naive " << t2 << "us\n";
+
+  test_ranking(cxt, 6, 20);
+  test_call_lookup(cxt);
+  test_template_call(cxt);
+}
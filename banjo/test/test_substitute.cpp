@@ -69,6 +69,83 @@ test_subst_decl(Context& cxt)
 }
 
 
+// Non-dependent terms are not rebuilt, and substitution results
+// are memoized across equivalent substitutions.
+void
+test_subst_memo(Context& cxt)
+{
+  Builder build(cxt);
+
+  Decl& parm = build.make_type_parameter("T");
+  Type& t = build.get_typename_type(parm);
+  Type& z = build.get_int_type();
+
+  // A closed type is returned unchanged.
+  Type& c = build.get_pointer_type(build.get_pointer_type(z));
+  Substitution s0;
+  s0.map_to(parm, z);
+  lingo_assert(!is_dependent(c));
+  lingo_assert(&substitute(cxt, c, s0) == &c);
+
+  // Equivalent substitutions share results, even when their
+  // arguments are distinct objects.
+  Type_list ps {&build.get_pointer_type(t), &c};
+  Type& f = build.get_function_type(ps, t);
+  lingo_assert(is_dependent(f));
+  Substitution s1;
+  s1.map_to(parm, build.get_pointer_type(z));
+  Substitution s2;
+  s2.map_to(parm, build.get_pointer_type(z));
+  Type& r1 = substitute(cxt, f, s1);
+  Type& r2 = substitute(cxt, f, s2);
+  lingo_assert(&r1 == &r2);
+  lingo_assert(!is_dependent(r1));
+
+  // The closed parameter type is shared with the original.
+  Function_type& g = cast<Function_type>(r1);
+  lingo_assert(&*++g.parameter_types().begin() == &c);
+
+  // A reference to a parameter of dependent type is dependent.
+  Expr& x1 = build.make_reference(build.make_object_parm("x", t));
+  Expr& x2 = build.make_reference(build.make_object_parm("y", z));
+  lingo_assert(is_dependent(x1));
+  lingo_assert(!is_dependent(x2));
+}
+
+
+
+// Template parameters are mapped by their index.
+void
+test_subst_index(Context& cxt)
+{
+  Builder build(cxt);
+
+  Type_parm& t = build.make_type_parameter("T");
+  Type_parm& u = build.make_type_parameter("U");
+  Type& v = build.get_void_type();
+  build.make_template({&t, &u}, build.make_variable("v", v));
+  lingo_assert(t.index().offset() == 0 && u.index().offset() == 1);
+
+  Type& z = build.get_int_type();
+  Type& b = build.get_bool_type();
+  Decl_list ps {&t, &u};
+  Term_list as {&z, &b};
+  Substitution sub(ps, as);
+  lingo_assert(sub.get_mapping(u) == &b);
+
+  // A parameter with the same index is equivalent to U.
+  Type_parm& w = build.make_type_parameter("W");
+  w.index() = u.index();
+  lingo_assert(&substitute(cxt, build.get_typename_type(w), sub) == &b);
+
+  // A parameter at a different depth is not mapped.
+  Type_parm& x = build.make_type_parameter("X");
+  x.index().pair() = {1, 0};
+  Type& xt = build.get_typename_type(x);
+  lingo_assert(!sub.has_mapping(x));
+  lingo_assert(&substitute(cxt, xt, sub) == &xt);
+}
+
 
 int
 main(int argc, char* argv[])
@@ -76,4 +153,6 @@ main(int argc, char* argv[])
   Context cxt;
   test_subst_type(cxt);
   test_subst_decl(cxt);
+  test_subst_memo(cxt);
+  test_subst_index(cxt);
 }
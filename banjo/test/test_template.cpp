@@ -5,8 +5,10 @@
 
 #include <banjo/template.hpp>
 #include <banjo/substitution.hpp>
+#include <banjo/equivalence.hpp>
 
 #include <iostream>
+#include <string>
 
 
 void
@@ -55,6 +57,26 @@ test_specialize(Context& cxt)
   std::cout << tv1 << "\n   vvvv\n";
   Decl& ts1 = specialize_template(cxt, tv1, args);
   std::cout << ts1 << '\n';
+
+  // Equivalent arguments name the same specialization.
+  Term_list args2 {&build.get_int_type()};
+  lingo_assert(&specialize_template(cxt, tv1, args2) == &ts1);
+  lingo_assert(tv1.hits == 1 && tv1.misses == 1);
+
+  // Structurally equivalent compound types, too.
+  Term_list args3 {&build.get_pointer_type(arg)};
+  Term_list args4 {&build.get_pointer_type(arg)};
+  Decl& ts3 = specialize_template(cxt, tv1, args3);
+  lingo_assert(&ts3 != &ts1);
+  lingo_assert(&specialize_template(cxt, tv1, args4) == &ts3);
+  lingo_assert(tv1.hits == 2 && tv1.misses == 2);
+  lingo_assert(tv1.specializations().size() == 2);
+
+  // Template-ids are unique for equivalent arguments.
+  Name& n1 = build.get_template_id(tv1, args2);
+  lingo_assert(&n1 == &ts1.name());
+  lingo_assert(&build.get_template_id(tv1, args4) == &ts3.name());
+  lingo_assert(&n1 != &ts3.name());
 }
 
 
@@ -84,6 +106,149 @@ test_synthesis(Context& cxt)
   std::cout << "tmp2\n" << tmp2 << '\n';
   std::cout << is_more_specialized(cxt, tmp1, tmp2) << ' '
             << is_more_specialized(cxt, tmp2, tmp1) << '\n';
+
+  // Orderings and transformed types are computed once.
+  std::size_t n = cxt.template_state().orders.size();
+  lingo_assert(n == 2 && cxt.template_state().xforms.size() == 2);
+  lingo_assert(is_more_specialized(cxt, tmp2, tmp1));
+  lingo_assert(cxt.template_state().orders.size() == n);
+}
+
+
+void
+test_instantiate(Context& cxt)
+{
+  Builder build(cxt);
+
+  // template<typename T> def f(T x) -> T { return true; }
+  Type_parm& tp = build.make_type_parameter("T");
+  Type& t = build.get_typename_type(tp);
+  Object_parm& x = build.make_object_parm("x", t);
+  Function_decl& f = build.make_function("f", {&x}, t);
+  Template_decl& tmp = build.make_template({&tp}, f);
+  Stmt_list ss {&build.make_return_statement(build.get_true())};
+  f.def = &build.make_function_definition(build.make_compound_statement(ss));
+
+  Term_list a1 {&build.get_int_type()};
+  Term_list a2 {&build.get_bool_type()};
+  Function_decl& s1 = cast<Function_decl>(specialize_template(cxt, tmp, a1));
+  Function_decl& s2 = cast<Function_decl>(specialize_template(cxt, tmp, a2));
+
+  // Requests are deduplicated, and definitions are instantiated
+  // only when pending requests are drained.
+  request_instantiation(cxt, s1);
+  request_instantiation(cxt, s1);
+  lingo_assert(cxt.template_state().pending.size() == 1);
+  lingo_assert(!s1.is_definition());
+  instantiate_pending(cxt);
+  lingo_assert(cxt.template_state().pending.empty());
+  lingo_assert(s1.is_definition());
+  lingo_assert(!s2.is_definition());
+
+  // Each specialization is instantiated at most once.
+  Def* def = s1.def;
+  request_instantiation(cxt, s1);
+  instantiate_pending(cxt);
+  lingo_assert(s1.def == def);
+
+  // template<typename T> def g(T x) -> T { var y : T = x; return y; }
+  Object_parm& gx = build.make_object_parm("x", t);
+  Function_decl& g = build.make_function("g", {&gx}, t);
+  Template_decl& gtmp = build.make_template({&tp}, g);
+  Expr& gi = build.make_copy_init(t, build.make_reference(gx));
+  Variable_decl& gy = build.make_variable("y", t, gi);
+  Stmt_list gs {
+    &build.make_declaration_statement(gy),
+    &build.make_return_statement(build.make_reference(gy))
+  };
+  g.def = &build.make_function_definition(build.make_compound_statement(gs));
+
+  // References in the instantiated body are bound to the parameters
+  // and locals of the specialization.
+  Function_decl& s4 = cast<Function_decl>(specialize_template(cxt, gtmp, a1));
+  request_instantiation(cxt, s4);
+  instantiate_pending(cxt);
+  Function_def& def4 = cast<Function_def>(s4.definition());
+  Stmt_list& body = cast<Compound_stmt>(def4.statement()).statements();
+  Variable_decl& y = cast<Variable_decl>(cast<Declaration_stmt>(body.front()).declaration());
+  Copy_init& i = cast<Copy_init>(y.initializer());
+  Reference_expr& r1 = cast<Reference_expr>(i.expression());
+  Reference_expr& r2 = cast<Reference_expr>(cast<Return_stmt>(body.back()).expression());
+  lingo_assert(&r1.declaration() == &s4.parameters().front());
+  lingo_assert(&r2.declaration() == &y);
+  lingo_assert(&y != &gy && is_equivalent(y.type(), build.get_int_type()));
+
+  // template<typename T> def h(T x) -> T { return g<T>(x); }
+  Object_parm& hx = build.make_object_parm("x", t);
+  Function_decl& h = build.make_function("h", {&hx}, t);
+  Template_decl& htmp = build.make_template({&tp}, h);
+  Term_list ta {&t};
+  Function_decl& gt = cast<Function_decl>(specialize_template(cxt, gtmp, ta));
+  Expr_list hargs {&build.make_reference(hx)};
+  Expr& hc = build.make_call(t, build.make_reference(gt), hargs);
+  Stmt_list hs {&build.make_return_statement(hc)};
+  h.def = &build.make_function_definition(build.make_compound_statement(hs));
+
+  // Instantiating h<bool> requests and instantiates g<bool>.
+  Function_decl& s5 = cast<Function_decl>(specialize_template(cxt, htmp, a2));
+  Function_decl& s6 = cast<Function_decl>(specialize_template(cxt, gtmp, a2));
+  request_instantiation(cxt, s5);
+  instantiate_pending(cxt);
+  lingo_assert(s5.is_definition() && s6.is_definition());
+  Function_def& def5 = cast<Function_def>(s5.definition());
+  Stmt_list& body5 = cast<Compound_stmt>(def5.statement()).statements();
+  Call_expr& c5 = cast<Call_expr>(cast<Return_stmt>(body5.front()).expression());
+  lingo_assert(&cast<Reference_expr>(c5.function()).declaration() == &s6);
+}
+
+
+void
+test_recursion(Context& cxt)
+{
+  Builder build(cxt);
+  Template_state& st = cxt.template_state();
+
+  // template<typename T> var v : T;
+  Type_parm& tp = build.make_type_parameter("T");
+  Type& t = build.get_typename_type(tp);
+  Template_decl& tmp = build.make_template({&tp}, build.make_variable("v", t));
+  Term_list a1 {&build.get_int_type()};
+  Term_list a2 {&build.get_bool_type()};
+  Name& n1 = build.get_template_id(tmp, a1);
+  Name& n2 = build.get_template_id(tmp, a2);
+
+  // Re-entering an instantiation in progress is an error. The
+  // diagnostic lists the instantiations in progress, innermost first.
+  std::string msg;
+  try {
+    Enter_instantiation i1(cxt, n1);
+    Enter_instantiation i2(cxt, n2);
+    lingo_assert(st.insts.size() == 2);
+    Enter_instantiation i3(cxt, n1);
+  } catch (Instantiation_error& err) {
+    msg = err.what();
+  }
+  lingo_assert(msg == "recursive instantiation of 'v<int32>'\n"
+                      "  required by 'v<bool>'\n"
+                      "  required by 'v<int32>'");
+  lingo_assert(st.insts.empty() && st.active.empty());
+
+  // Instantiation depth is limited.
+  bool limited = false;
+  st.limit = 1;
+  try {
+    Enter_instantiation i1(cxt, n1);
+    Enter_instantiation i2(cxt, n2);
+  } catch (Limitation_error& err) {
+    limited = true;
+  }
+  lingo_assert(limited);
+  lingo_assert(st.insts.empty());
+
+  // Specialization is tracked, and within the limit.
+  specialize_template(cxt, tmp, a1);
+  lingo_assert(st.insts.empty());
+  st.limit = 1024;
 }
 
 
@@ -95,4 +260,6 @@ main(int argc, char* argv[])
   test_basics(cxt);
   test_specialize(cxt);
   test_synthesis(cxt);
+  test_instantiate(cxt);
+  test_recursion(cxt);
 }